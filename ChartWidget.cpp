@@ -1,24 +1,20 @@
 #include "chartwidget.h"
+#include "chartlayout.h"
+#include "signalloader.h"
 
 #include <QString>
-#include <QTextStream>
-#include <QFile>
 #include <QMessageBox>
 #include <QTimer>
 #include <QDebug>
+#include <QtConcurrent>
 
 
 ChartWidget::ChartWidget( QWidget *parent )  // def NULL
 	: QOpenGLWidget( parent ),
-	  m_numDataPoints( 0 ),
 	  m_dimensions( 2 ),
-	  m_xDomain( 2.0 ),
-	  m_yDomain( 1.0 ),
-	  m_yCoverage( 0.8 ),
-	  m_tickSize( 1000 ),
-	  m_numTicks( 0 ),
-	  m_xTickStep( 0.0 ),
-	  m_xStep( 0.0 ),
+	  m_xDomain( ChartLayout::s_xDomain ),
+	  m_yDomain( ChartLayout::s_yDomain ),
+	  m_yCoverage( ChartLayout::s_yCoverage ),
 	  m_aspectRatioWidth( 1.0f ),
 	  m_aspectRatioHeight( 1.0f ),
 	  m_zoomFactor( 1.0f ),
@@ -26,12 +22,20 @@ ChartWidget::ChartWidget( QWidget *parent )  // def NULL
 	  m_yPan( 0.0f ),
 	  m_near( 0.1f ),
 	  m_far( 1.0f ),
-	  m_smoothOn( false ),
+	  m_bTimeLocked( false ),
+	  m_smoothOn( true ),
+	  m_densityOn( false ),
+	  m_densityGeneration( 0 ),
+	  m_densityTexture( 0 ),
+	  m_correlationGeneration( 0 ),
+	  m_bAlignOnCorrelation( false ),
 	  m_recordingPeak( false ),
 	  m_recordingValley( false ),
 	  m_currentPeak( 0.0f ),
 	  m_currentValley( 0.0f ),
 	  m_peakTime( 0 ),
+	  m_recordFirstTime( 0 ),
+	  m_recordLastTime( 0 ),
 	  m_peakX( 0.0f ),
 	  m_peakY( 0.0f ),
 	  m_lastPeakX( 0.0f ),
@@ -48,11 +52,20 @@ ChartWidget::ChartWidget( QWidget *parent )  // def NULL
 				   */
 	setFocusPolicy( Qt::StrongFocus );
 
+	// the widget is a view over the signals of its store
+	m_store = std::make_shared< SignalStore >();
+	m_snapshot = m_store->snapshot();
+	connect( m_store.get(), SIGNAL( qtsignalSnapshotChanged() ),
+			 this, SLOT( qtslotSnapshotChanged() ) );
+
 	QTimer *timer = new QTimer(this);
 	connect( timer, SIGNAL( timeout() ),
 			 this, SLOT( update() ) );
 	timer->start( 1000 );
 
+	connect( &m_correlationWatcher, SIGNAL( finished() ),
+			 this, SLOT( qtslotCorrelationFinished() ) );
+
 	// initialize the reverse transform to identity
 	m_screenToModel[ 0 ] = 1.0f;
 	m_screenToModel[ 1 ] = m_screenToModel[ 2 ] = m_screenToModel[ 3 ] = m_screenToModel[ 4 ] = 0.0f;
@@ -67,7 +80,27 @@ ChartWidget::ChartWidget( QWidget *parent )  // def NULL
 
 ChartWidget::~ChartWidget()
 {
+	if ( m_densityTexture )
+	{
+		makeCurrent();
+		glDeleteTextures( 1, &m_densityTexture );
+		doneCurrent();
+	}
+}
 
+// shows the signals of the given store instead of those of the current one
+void ChartWidget::setSignalStore( const std::shared_ptr< SignalStore > &store )
+{
+	Q_ASSERT( store );
+	disconnect( m_store.get(), SIGNAL( qtsignalSnapshotChanged() ),
+				this, SLOT( qtslotSnapshotChanged() ) );
+	m_store = store;
+	connect( m_store.get(), SIGNAL( qtsignalSnapshotChanged() ),
+			 this, SLOT( qtslotSnapshotChanged() ) );
+
+	// the hits of the density display were counted on the signals of the other store
+	m_densities.clear();
+	qtslotSnapshotChanged();
 }
 
 void ChartWidget::qtslotFileChanged( QString &filename )
@@ -78,149 +111,107 @@ void ChartWidget::qtslotFileChanged( QString &filename )
 	Q_ASSERT( addSignalFile( filename ) );
 }
 
-
-// displays an error and returns false if the file is formatted incorrectly or could not be opened
-bool ChartWidget::readDataFile( const QString &filename,
-								QVector<float> &data,
-								float &smallestY,
-								float &largestY )
+void ChartWidget::qtslotSetEventThreshold( double threshold )
 {
-	QFile file( filename );
-	if ( !file.open( QIODevice::ReadOnly ) )
-	{
-		QString sError( "Could not open file: " );
-		sError.append( filename );
-		QMessageBox::information( 0, sError, file.errorString() );
-		return false;
-	}
-
-	QTextStream in( &file );
+	m_store->setEventThreshold( threshold );
+}
 
-	smallestY = 1.;
-	largestY = -1.;
-	bool bOk = true;
-	while ( !in.atEnd() )
-	{
-		QString line = in.readLine();
-		QStringList fields = line.split(" ");
-		if ( fields.size() != 1 )
-		{
-			file.close();
+void ChartWidget::qtslotSetTimeView( float centerX, float halfWidth )
+{
+	if ( !m_bTimeLocked )
+		return;
 
-			QString sError( "More than one value per line. Ignored: " );
-			sError.append( filename );
-			QMessageBox::information( 0, sError, file.errorString() );
-			return false;
-		}
+	// the zoom factor is that which gives this chart, w/ its own aspect ratio, the same half width
+	updateAspectRatioWidthHeight( width(), height() );
+	m_xPan = 1.0f - centerX;
+	m_zoomFactor = qMax( halfWidth / m_aspectRatioWidth, 0.1f );
 
-		// float fData = std::atof( fields.at( 0 ).toLocal8Bit().constData() );
-		float fData = fields.at( 0 ).toFloat( &bOk );
-		if ( !bOk )
-		{
-			file.close();
+	// the mouse maps through the new view before it is painted
+	updateInverseTransform();
+	update();
+}
 
-			QString sError( "Contains non-numbers. Ignored: " );
-			sError.append( filename );
-			QMessageBox::information( 0, sError, file.errorString() );
-			return false;
-		}
+void ChartWidget::qtslotCorrelate( int first, int second, bool bAlign )
+{
+	if ( first < 0 || second < 0 ||
+		 first >= m_snapshot->signalCount() || second >= m_snapshot->signalCount() )
+		return;
 
-		if ( fData > largestY )
-			largestY = fData;
-		if ( fData < smallestY )
-			smallestY = fData;
+	// the worker holds on to the snapshot, so the signals may be replaced while it runs
+	SignalSnapshotPtr snapshot = m_snapshot;
+	m_correlationStore = m_store;
+	m_correlationGeneration = snapshot->generation;
+	m_bAlignOnCorrelation = bAlign;
+	m_correlationWatcher.setFuture( QtConcurrent::run( [=]()
+	{
+		SignalLag lag = SignalCorrelation::bestLag( snapshot->vectorSignals.at( first ),
+													snapshot->vectorSignals.at( second ) );
+		lag.first = first;
+		lag.second = second;
+		return lag;
+	} ) );
+}
 
-		data.push_back( fData );
-	}  // end while not at EOF
+void ChartWidget::qtslotCorrelationFinished()
+{
+	SignalLag lag = m_correlationWatcher.result();
+	if ( !lag.bValid )
+		return;
 
-	file.close();
+	// the signals the lag was found for may have been cleared, or the chart moved to another
+	// store, while it ran
+	SignalSnapshotPtr snapshot = m_store->snapshot();
+	if ( m_correlationStore.lock() != m_store ||
+		 snapshot->generation != m_correlationGeneration ||
+		 lag.first >= snapshot->signalCount() ||
+		 lag.second >= snapshot->signalCount() )
+		return;
 
-	return true;
-}  // end readDataFile
+	emit qtsignalCorrelationFound( lag.first, lag.second, lag.lag, lag.coefficient );
 
+	// the lag is between the data points of the signals, so it is relative to where the first
+	// one is shown
+	if ( m_bAlignOnCorrelation )
+		m_store->setTimeOffset( lag.second, snapshot->timeOffsets.at( lag.first ) + lag.lag );
+}
 
-// loads the data of the given file unless the call readDataFile() returns an error, or the
-// number of data points is inconsistent w/ that of previously loaded files
-// should always return true
-bool ChartWidget::addSignalFile( QString &filename )
+// takes the latest version of the signals of the store
+void ChartWidget::qtslotSnapshotChanged()
 {
-	// only allow loading 7 signal files -- this is an artificial limit based on the number of
-	// colors I defined for the signals -- otherwise, there is no limit
-	if ( m_vectorSignals.count() + 1 > 7 )
-	{
-		QString sError( "Maximum number of signal files already loaded. Ignored: " );
-		sError.append( filename );
-		QFile file( filename );
-		QMessageBox::information( 0, sError, file.errorString() );
-	}
+	m_snapshot = m_store->snapshot();
+	m_timeAtMouse = qBound( m_snapshot->firstTime(), m_timeAtMouse, qMax( m_snapshot->lastTime(), 0 ) );
 
-	// read the data points in this file
-	QVector<float> data;
-	float smallestY = 0.,
-			largestY = 0.;
-	bool bOk = readDataFile( filename, data, smallestY, largestY );
-	if ( !bOk )
-		// ignore bad data file and keep going
-		// error has already been displayed by readDataFile()
-		return true;
-
-	// make sure the number of data points in all files is consistent
-	int dataPoints = data.size();
-	if ( m_numDataPoints &&
-		 dataPoints != m_numDataPoints )
-	{
-		QString sError( "Number of data points is not the same as that of previously loaded files. Ignored: " );
-		sError.append( filename );
-		QFile file( filename );
-		QMessageBox::information( 0, sError, file.errorString() );
-		return true;
-	}
+	// refresh the screen w/ the new data
+	update();
+}
 
-	if ( !m_numDataPoints )
+
+// loads the given file into the store the way SignalLoader does, and displays the error if
+// it could not be loaded
+bool ChartWidget::readDataFile( const QString &filename )
+{
+	QString sError;
+	if ( !SignalLoader::addFile( filename, m_fileReader, *m_store, sError ) )
 	{
-		// this is the 1st file read so set the chart parameters
-		m_numDataPoints = dataPoints;
-
-		// the X axis tick size is the number of data points between
-		// tick marks
-		QString sDataPoints =
-			QString::fromStdString( std::to_string( m_numDataPoints ) );
-		int length = sDataPoints.size();
-		m_tickSize = (int) floor( pow( 10, length-1 ) );
-		Q_ASSERT( m_tickSize > 0 );
-
-		// set the number of ticks for the graph
-		m_numTicks = m_numDataPoints / m_tickSize;
-		if ( m_numDataPoints % m_tickSize )
-			m_numTicks++;
-		Q_ASSERT( m_numTicks > 0 );
-
-		// set the distance between tick marks on the X axis
-		m_xTickStep = m_xDomain / m_numTicks;
-
-		// set the distance between data points on the X axis
-		m_xStep = m_xTickStep / m_tickSize;
-		Q_ASSERT( m_xStep > 0.0f );
+		QMessageBox::information( 0, sError, filename );
+		return false;
 	}
 
-	// add the data points to the data point structure
-	QVector<float> vectorEmpty;
-	m_vectorSignals.push_back( vectorEmpty );
-	m_vectorSignals.last().swap( data );
-
-	// add the signal scale factor for this data file
-	float signalScale = m_yDomain * .5 * m_yCoverage;
-	if ( fabs( smallestY ) > largestY )
-		signalScale /= fabs( smallestY );
-	else
-		signalScale /= largestY;
-	m_vectorScales.push_back( signalScale );
-
-	// refresh the screen w/ the new data
-	update();
+	// the screen is refreshed once the store publishes the new data
+	return true;
+}
 
+// adds every column of the given file as a separate signal to the store unless the call
+// readDataFile() returns an error, or the number of data points is inconsistent w/ that of
+// previously loaded files
+// should always return true
+bool ChartWidget::addSignalFile( QString &filename )
+{
+	// ignore a bad data file and keep going, the error has already been displayed by
+	// readDataFile()
+	readDataFile( filename );
 	return true;
-}  // end addSignalFile
+}
 
 QSize ChartWidget::minimumSizeHint() const
 {
@@ -444,11 +435,11 @@ void ChartWidget::draw()
 
 	// draw the horizonal ticks on the X axis
 	int ii = 0;
-	for ( ii=1; ii<m_numTicks; ii++ )
+	for ( ii=1; ii<m_snapshot->numTicks; ii++ )
 	{
 		glBegin(GL_LINES);
-		glVertex2d( m_xTickStep * ii, -0.1 );
-		glVertex2d( m_xTickStep * ii, 0.1 );
+		glVertex2d( m_snapshot->xTickStep * ii, -ChartLayout::s_tickHeight );
+		glVertex2d( m_snapshot->xTickStep * ii, ChartLayout::s_tickHeight );
 		glEnd();
 	}
 
@@ -476,66 +467,162 @@ void ChartWidget::draw()
 	glEnd();
 
 
-	// draw the signals read so far
-	for ( ii=0; ii<m_vectorSignals.size(); ii++ )
+	if ( m_densityOn )
 	{
-		switch ( ii ) {
-		case 0:
-			glColor3f( 1.0f, 0.0f, 0.0f );  //red
-			break;
-		case 1:
-			glColor3f( 0.0f, 1.0f, 0.0f );  // green
-			break;
-		case 2:
-			glColor3f( 0.0f, 0.0f, 1.0f );  // blue
-			break;
-		case 3:
-			glColor3f( 1.0f, 1.0f, 0.0f );  // yellow
-			break;
-		case 4:
-			glColor3f( 1.0f, 0.0f, 1.0f );  // purple
-			break;
-		case 5:
-			glColor3f( 1.0f, 0.5f, 0.0f );  // orange
-			break;
-		case 6:
-			glColor3f( 0.0f, 1.0f, 1.0f );  // cyan
-			break;
-		default:
-			break;
-		}
+		drawDensity();
+		return;
+	}
 
-		const QVector< float > *pSignal = &m_vectorSignals.at( ii );
+	// draw the signals read so far, the lines are built in model coordinates but widened
+	// in pixels
+	float xPixel = 2.0f * m_screenToModel[ 0 ] / qMax( width(), 1 ),
+			yPixel = 2.0f * m_screenToModel[ 5 ] / qMax( height(), 1 );
+	for ( ii=0; ii<m_snapshot->vectorSignals.size(); ii++ )
+	{
+		const float *pColor = ChartLayout::s_signalColors[ ii ];
+		glColor3fv( pColor );
+
+		const QVector< float > *pSignal = &m_snapshot->vectorSignals.at( ii );
 		int count = pSignal->size();
 		if ( count < 2 )
 			continue;
 
-		if ( m_smoothOn )
+		// only draw the data points in view, data point jj being shown at time jj + offset
+		int firstTime = 0,
+				lastTime = 0,
+				offset = m_snapshot->timeOffsets.at( ii );
+		getVisibleRange( firstTime, lastTime );
+		firstTime = qMax( firstTime - offset, 0 );
+		lastTime = qMin( lastTime - offset, count - 1 );
+		if ( firstTime > lastTime )
+			continue;
+
+		// when there are several data points per pixel, draw the min/max envelope of the
+		// pyramid level whose blocks are about a pixel wide instead of every data point
+		float scale = m_snapshot->scale( ii );
+		const SignalSummary &summary = m_snapshot->vectorSummaries.at( ii );
+		int level = summary.levelForSamples( ( lastTime - firstTime ) / qMax( width(), 1 ) );
+		m_polyline.clear( xPixel, yPixel );
+		if ( level >= 0 )
 		{
-			glEnable( GL_LINE_SMOOTH );
-			glHint( GL_LINE_SMOOTH_HINT, GL_NICEST );
-			glEnable(GL_BLEND);
-			glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-			glBegin( GL_LINE_STRIP );
+			const QVector< float > &minima = summary.minima( level ),
+					&maxima = summary.maxima( level );
+			int blockSize = summary.blockSize( level );
+			int lastBlock = qMin( lastTime / blockSize, minima.size() - 1 );
+			for ( int jj=firstTime/blockSize; jj<=lastBlock; jj++ )
+			{
+				// blocks of nothing but missing data points break the envelope
+				if ( minima.at( jj ) != minima.at( jj ) )
+				{
+					m_polyline.breakLine();
+					continue;
+				}
+
+				float x = m_snapshot->xStep * ( jj * blockSize + blockSize / 2 + offset );
+				m_polyline.addPoint( x, minima.at( jj ) * scale );
+				m_polyline.addPoint( x, maxima.at( jj ) * scale );
+			}
 		}
 		else
-			glBegin(GL_LINES);
-		for ( int jj=0; jj<count; jj++ )
 		{
-			glVertex2d( m_xStep * jj,
-						pSignal->at( jj ) * m_vectorScales.at( ii ) );
+			for ( int jj=firstTime; jj<=lastTime; jj++ )
+			{
+				// missing data points break the line
+				if ( pSignal->at( jj ) != pSignal->at( jj ) )
+					m_polyline.breakLine();
+				else
+					m_polyline.addPoint( m_snapshot->xStep * ( jj + offset ), pSignal->at( jj ) * scale );
+			}
 		}
 
-		glEnd();
-	}
+		if ( m_smoothOn )
+			m_polyline.drawAntialiased( pColor );
+		else
+			m_polyline.draw();
+	}  // end for each signal
 }  // end draw
 
+// draws the signals as an intensity map of how many of their line segments go over each pixel,
+// in the color of each signal
+void ChartWidget::drawDensity()
+{
+	if ( !m_snapshot->signalCount() || width() < 1 || height() < 1 )
+		return;
+
+	// a grid of pixels anchored at the origin of the model, w/ an extra column and row to cover
+	// the fraction of a pixel the view is offset from it
+	DensityGrid grid;
+	grid.columnWidth = 2.0f * m_screenToModel[ 0 ] / width();
+	grid.rowHeight = 2.0f * m_screenToModel[ 5 ] / height();
+	grid.firstColumn = (int) floor( ( m_screenToModel[ 3 ] - m_screenToModel[ 0 ] ) / grid.columnWidth );
+	grid.firstRow = (int) floor( ( m_screenToModel[ 7 ] - m_screenToModel[ 5 ] ) / grid.rowHeight );
+	grid.columns = width() + 1;
+	grid.rows = height() + 1;
+
+	// the hits counted so far are only valid for the signals they were counted on
+	if ( m_densityGeneration != m_snapshot->generation )
+	{
+		m_densities.clear();
+		m_densityGeneration = m_snapshot->generation;
+	}
+	m_densities.resize( m_snapshot->signalCount() );
+
+	m_densityPixels.fill( 0, 4 * grid.columns * grid.rows );
+	for ( int ii=0; ii<m_snapshot->signalCount(); ii++ )
+	{
+		m_densities[ ii ].accumulate( m_snapshot->vectorSignals.at( ii ), m_snapshot->xStep,
+									  m_snapshot->scale( ii ), m_snapshot->timeOffsets.at( ii ), grid );
+		m_densities.at( ii ).paint( ChartLayout::s_signalColors[ ii ], m_densityPixels.data() );
+	}
+
+	if ( !m_densityTexture )
+		glGenTextures( 1, &m_densityTexture );
+	glBindTexture( GL_TEXTURE_2D, m_densityTexture );
+	glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST );
+	glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST );
+	glPixelStorei( GL_UNPACK_ALIGNMENT, 1 );
+	glTexImage2D( GL_TEXTURE_2D, 0, GL_RGBA, grid.columns, grid.rows, 0,
+				  GL_RGBA, GL_UNSIGNED_BYTE, m_densityPixels.constData() );
+
+	// add the map over the axes
+	float left = grid.firstColumn * grid.columnWidth,
+			right = ( grid.firstColumn + grid.columns ) * grid.columnWidth,
+			bottom = grid.firstRow * grid.rowHeight,
+			top = ( grid.firstRow + grid.rows ) * grid.rowHeight;
+	glEnable( GL_TEXTURE_2D );
+	glEnable( GL_BLEND );
+	glBlendFunc( GL_ONE, GL_ONE );
+	glColor3f( 1.0f, 1.0f, 1.0f );
+	glBegin( GL_QUADS );
+	glTexCoord2f( 0.0f, 0.0f );
+	glVertex2d( left, bottom );
+	glTexCoord2f( 1.0f, 0.0f );
+	glVertex2d( right, bottom );
+	glTexCoord2f( 1.0f, 1.0f );
+	glVertex2d( right, top );
+	glTexCoord2f( 0.0f, 1.0f );
+	glVertex2d( left, top );
+	glEnd();
+	glDisable( GL_TEXTURE_2D );
+	glDisable( GL_BLEND );
+}  // end drawDensity
+
+// returns the range of times visible in the chart, which is left to the callers to clamp to the
+// data points of each signal since their time offsets shift them
+void ChartWidget::getVisibleRange( int &firstTime, int &lastTime ) const
+{
+	float maxX = m_screenToModel[0] + m_screenToModel[3],
+			minX = -m_screenToModel[0] + m_screenToModel[3];
+	firstTime = (int) floor( minX / m_snapshot->xStep );
+	lastTime = (int) ceil( maxX / m_snapshot->xStep );
+}
+
 /* -- code for managing the display ends here ----------------------------------*/
 
 
 void ChartWidget::mousePressEvent(QMouseEvent *event)
 {
-	if ( !m_vectorScales.count() )
+	if ( !m_snapshot->signalCount() )
 		return;
 
 	lastPos = event->pos();
@@ -544,6 +631,9 @@ void ChartWidget::mousePressEvent(QMouseEvent *event)
 	if ( event->modifiers().testFlag( Qt::ControlModifier ) )
 		return;
 
+	// the range of data points swept while recording starts at the mouse
+	m_recordFirstTime = m_recordLastTime = getSignalIndex( event->x() );
+
 	// clear the peak or valley widgets and start recording
 	if ( event->buttons() &
 		Qt::LeftButton )
@@ -566,7 +656,7 @@ void ChartWidget::mousePressEvent(QMouseEvent *event)
 
 void ChartWidget::mouseReleaseEvent(QMouseEvent * event)
 {
-	if ( !m_vectorScales.count() )
+	if ( !m_snapshot->signalCount() )
 		return;
 
 	// don't handle panning or zooming using the control key
@@ -588,11 +678,15 @@ void ChartWidget::mouseReleaseEvent(QMouseEvent * event)
 			return;
 		}
 
-		refineMaximum( 0, m_peakTime, m_currentPeak, true );
-		emit qtsignalUpdatePeakValue( m_currentPeak, m_peakTime );
+		// the mouse may have skipped data points, so take the peak of all the data points swept
+		if ( findSweptExtremum( 0, true, m_peakTime, m_currentPeak ) )
+		{
+			emit qtsignalUpdatePeakValue( m_currentPeak, m_peakTime );
+			updateRangeStatistics();
 
-		// highlight the peak
-		highlightPeak( 0, m_peakTime, m_currentPeak );
+			// highlight the peak
+			highlightPeak( 0, m_peakTime, m_currentPeak );
+		}
 
 		// turn off the update of the last peak until we start recording a peak again
 		m_recordingPeak = false;
@@ -607,11 +701,14 @@ void ChartWidget::mouseReleaseEvent(QMouseEvent * event)
 			return;
 		}
 
-		refineMaximum( 0, m_peakTime, m_currentValley, false );
-		emit qtsignalUpdatePeakValue( m_currentValley, m_peakTime );
+		if ( findSweptExtremum( 0, false, m_peakTime, m_currentValley ) )
+		{
+			emit qtsignalUpdatePeakValue( m_currentValley, m_peakTime );
+			updateRangeStatistics();
 
-		// highlight the valley
-		highlightValley( 0, m_peakTime, m_currentValley );
+			// highlight the valley
+			highlightValley( 0, m_peakTime, m_currentValley );
+		}
 
 		// turn off the update of the last valley until we start recording a valley again
 		m_recordingValley = false;
@@ -620,7 +717,7 @@ void ChartWidget::mouseReleaseEvent(QMouseEvent * event)
 
 void ChartWidget::mouseMoveEvent(QMouseEvent *event)
 {
-	if ( !m_vectorScales.count() )
+	if ( !m_snapshot->signalCount() )
 		return;
 
 	int dx = event->x() - lastPos.x();
@@ -637,6 +734,7 @@ void ChartWidget::mouseMoveEvent(QMouseEvent *event)
 				m_zoomFactor = 0.1f;
 			setProjectionMatrix( width(), height(), m_zoomFactor );
 			update();
+			timeViewChanged();
 			lastPos = event->pos();
 			return;
 		}
@@ -648,6 +746,7 @@ void ChartWidget::mouseMoveEvent(QMouseEvent *event)
 			m_xPan += (float) dx / width();
 			m_yPan += (float) -dy / height();
 			update();
+			timeViewChanged();
 			lastPos = event->pos();
 			return;
 		}
@@ -663,11 +762,30 @@ void ChartWidget::keyPressEvent(QKeyEvent *event)
 	{
 	  if ( event->key() == Qt::Key_S )
 	  {
-		// toggle smoothing
+		// toggle anti-aliasing
 		m_smoothOn = !m_smoothOn;
 		update();
 	  }
 
+	  else if ( event->key() == Qt::Key_L )
+	  {
+		// line the 2nd signal up w/ the 1st, or back to where it was if it is already shifted
+		if ( m_snapshot->signalCount() < 2 )
+			return;
+		if ( m_snapshot->timeOffsets.at( 1 ) )
+			m_store->setTimeOffset( 1, 0 );
+		else
+			qtslotCorrelate( 0, 1, true );
+	  }
+
+	  else if ( event->key() == Qt::Key_D )
+	  {
+		// toggle the density display, the hits are counted again when it is turned back on
+		m_densityOn = !m_densityOn;
+		m_densities.clear();
+		update();
+	  }
+
 	  // used only for testing
 	  else if ( event->key() == Qt::Key_1 )
 		  highlightSelectedDataPoint( 1 );
@@ -687,14 +805,45 @@ void ChartWidget::keyPressEvent(QKeyEvent *event)
 	  return;
 	}
 
+	// used to jump forward or backward in time to the next event of the 1st signal: its
+	// threshold crossings w/ shift and the arrow keys, its local extrema w/ alt and the arrow
+	// keys, and its gaps w/ page up and page down
+	bool bArrowKey = event->key() == Qt::Key_Left || event->key() == Qt::Key_Right;
+	bool bEventKey = true;
+	SignalEvents::Type eventType = SignalEvents::Gap;
+	if ( bArrowKey && event->modifiers().testFlag( Qt::ShiftModifier ) )
+		eventType = SignalEvents::Crossing;
+	else if ( bArrowKey && event->modifiers().testFlag( Qt::AltModifier ) )
+		eventType = SignalEvents::Extremum;
+	else if ( event->key() != Qt::Key_PageUp && event->key() != Qt::Key_PageDown )
+		bEventKey = false;
+
+	if ( bEventKey )
+	{
+		if ( !m_snapshot->signalCount() )
+			return;
+
+		// the events are indexed by data point, which is shown shifted by the time offset
+		bool bForward = event->key() == Qt::Key_Right || event->key() == Qt::Key_PageDown;
+		int offset = m_snapshot->timeOffsets.at( 0 ),
+				time = m_snapshot->vectorEvents.at( 0 ).find( eventType, m_timeAtMouse - offset, bForward );
+		if ( time < 0 )
+			return;
+		time += offset;
+
+		m_timeAtMouse = time;
+		centerOnTime( time );
+		updateValuesAtTime();
+		return;
+	}
+
 	// used to advance forward or backward in time by one data point
-	if ( event->key() == Qt::Key_Left ||
-		 event->key() == Qt::Key_Right )
+	if ( bArrowKey )
 	{
 		if ( event->key() == Qt::Key_Left )
 		{
-			// don't change the time to less than 0
-			if ( m_timeAtMouse <= 0 )
+			// don't change the time to before the first data point shown
+			if ( m_timeAtMouse <= m_snapshot->firstTime() )
 				return;
 			m_timeAtMouse--;
 		}
@@ -703,37 +852,56 @@ void ChartWidget::keyPressEvent(QKeyEvent *event)
 		{
 			// right arrow key
 			// don't change the time to more than the maximum time
-			if ( m_timeAtMouse >= m_numDataPoints - 1 )
+			if ( m_timeAtMouse >= m_snapshot->lastTime() )
 				return;
 			m_timeAtMouse++;
 		}
 
-		int count = m_vectorScales.count();
-		for ( int ii=0; ii<count; ii++ )
-		{
-		  const QVector< float > *pSignal = &m_vectorSignals.at( ii );
-		  emit qtsignalUpdateValue( ii, pSignal->at( m_timeAtMouse ), m_timeAtMouse );
-		}
+		updateValuesAtTime();
 	}
 
 	// used to move the current amplitude and time to the first signal peak widget
 	if ( event->key() == Qt::Key_Return )
 	{
-		const QVector< float > *pSignal = &m_vectorSignals.at( 0 );
-		emit qtsignalDisplayArbitraryDeltas( pSignal->at( m_timeAtMouse ), m_timeAtMouse );
+		emit qtsignalDisplayArbitraryDeltas( m_snapshot->value( 0, m_timeAtMouse ), m_timeAtMouse );
 	}
 
 	QWidget::keyPressEvent( event );
 }
 
+// updates the signal values at the current time on the widgets listening to qtsignalUpdateValue
+void ChartWidget::updateValuesAtTime()
+{
+	int count = m_snapshot->signalCount();
+	for ( int ii=0; ii<count; ii++ )
+	{
+	  emit qtsignalUpdateValue( ii, m_snapshot->value( ii, m_timeAtMouse ), m_timeAtMouse );
+	}
+}
+
+// pans the chart so the given time is in the middle of the view
+void ChartWidget::centerOnTime( int time )
+{
+	// the middle of the view is at 1 - m_xPan in model coordinates
+	m_xPan = 1.0f - m_snapshot->xStep * time;
+	update();
+	timeViewChanged();
+}
+
+// lets the charts time locked to this one follow its X axis
+void ChartWidget::timeViewChanged()
+{
+	emit qtsignalTimeViewChanged( 1.0f - m_xPan, m_aspectRatioWidth * m_zoomFactor );
+}
+
 // used only for testing
 void ChartWidget::highlightSelectedDataPoint( int signal )
 {
-	Q_ASSERT( signal <= m_vectorScales.count() );
+	Q_ASSERT( signal <= m_snapshot->signalCount() );
 
 	// find the closest signal data point
 	// we know the number of data points and the size of the X domain
-	const QVector< float > *pSignal = &m_vectorSignals.at( signal - 1 );
+	const QVector< float > *pSignal = &m_snapshot->vectorSignals.at( signal - 1 );
 	int count = pSignal->size();
 	if ( count < 2 )
 		return;
@@ -753,19 +921,19 @@ void ChartWidget::highlightSelectedDataPoint( int signal )
 	*/
 
 	// start w/ the visible portion of the range in case the user has
-	// zoomed in
+	// zoomed in, over the times at which any signal is shown
 	float maxNDC = m_screenToModel[0] + m_screenToModel[3],
 			minNDC = -m_screenToModel[0] + m_screenToModel[3];
-	int highIndex = qMin( (int) (maxNDC/m_xStep), m_numDataPoints ),
-			lowIndex = qMax( (int) (minNDC/m_xStep), 0 );
+	int highIndex = qMin( (int) floor( maxNDC/m_snapshot->xStep ), m_snapshot->lastTime() + 1 ),
+			lowIndex = qMax( (int) floor( minNDC/m_snapshot->xStep ), m_snapshot->firstTime() );
 
-	float dataX = m_xStep * highIndex;
+	float dataX = m_snapshot->xStep * highIndex;
 	while ( // fabs( dataX - x ) > 1.0e-3 &&
 			lowIndex < highIndex &&
 			highIndex - lowIndex > 1 )
 	{
 		int testIndex = ( highIndex - lowIndex ) >> 1;
-		dataX = m_xStep * ( lowIndex + testIndex );
+		dataX = m_snapshot->xStep * ( lowIndex + testIndex );
 		qDebug() << "low: " << lowIndex << " high: " << highIndex << " dataX: " << dataX;
 		if ( x < dataX )
 			highIndex = lowIndex + testIndex;
@@ -773,10 +941,11 @@ void ChartWidget::highlightSelectedDataPoint( int signal )
 			lowIndex += testIndex;
 	};
 
-	// draw a point at the selected location
-	float signalValue = pSignal->at( lowIndex );
+	// draw a point at the selected location, the data point shown there is shifted by the time
+	// offset of the signal
+	float signalValue = m_snapshot->value( signal - 1, lowIndex );
 	m_peakX = dataX;
-	m_peakY = signalValue  * m_vectorScales.at( signal - 1 );
+	m_peakY = signalValue  * m_snapshot->scale( signal - 1 );
 
 	emit qtsignalUpdateValue( signal - 1, signalValue, lowIndex );
 }  // end highlightSelectedDataPoint
@@ -785,33 +954,40 @@ void ChartWidget::highlightSelectedDataPoint( int signal )
 // updates the signal values on the widgets listening to qtsignalSetSignalValue
 void ChartWidget::updateSignalValues( int screenX )
 {
-	int count = m_vectorScales.count();
+	int count = m_snapshot->signalCount();
 	if ( !count )
 		return;
 
 	// get the closest signal index corr to the given X screen coord
 	m_timeAtMouse = getSignalIndex( screenX );
-	if ( m_timeAtMouse < 0 ||
-		 m_timeAtMouse > m_numDataPoints - 1 )
+	if ( m_timeAtMouse < m_snapshot->firstTime() ||
+		 m_timeAtMouse > m_snapshot->lastTime() )
 	{
 		// the call to getSignalIndex() failed
 		m_timeAtMouse = 0;
 		return;
 	}
 
+	if ( m_recordingPeak || m_recordingValley )
+	{
+		m_recordFirstTime = qMin( m_recordFirstTime, m_timeAtMouse );
+		m_recordLastTime = qMax( m_recordLastTime, m_timeAtMouse );
+	}
+
 	for ( int ii=0; ii<count; ii++ )
 	{
-		const QVector< float > *pSignal = &m_vectorSignals.at( ii );
+		const QVector< float > *pSignal = &m_snapshot->vectorSignals.at( ii );
 		int count = pSignal->size();
 		if ( count < 2 )
 			continue;
 
-		float signalValue = pSignal->at( m_timeAtMouse );
+		float signalValue = m_snapshot->value( ii, m_timeAtMouse );
 		emit qtsignalUpdateValue( ii, signalValue, m_timeAtMouse );
 
-		// record peaks and valleys
+		// record peaks and valleys, missing data points have neither
 		if ( m_recordingPeak &&
-			 ii == 0 )
+			 ii == 0 &&
+			 signalValue == signalValue )
 		{
 			if ( m_currentPeak == 0.0f ||
 				 signalValue > 	m_currentPeak )
@@ -822,7 +998,8 @@ void ChartWidget::updateSignalValues( int screenX )
 		}
 
 		if ( m_recordingValley &&
-			 ii == 0 )
+			 ii == 0 &&
+			 signalValue == signalValue )
 		{
 			if ( m_currentValley == 0.0f ||
 				 signalValue < 	m_currentValley )
@@ -832,13 +1009,39 @@ void ChartWidget::updateSignalValues( int screenX )
 			}
 		}
 	}
+
+	if ( m_recordingPeak || m_recordingValley )
+		updateRangeStatistics();
 }  // end updateSignalValues
 
 
+// updates the statistics of every signal over the range of data points swept while recording
+// a peak or valley on the widgets listening to qtsignalUpdateRangeStatistics
+// takes constant time regardless of the length of the range
+void ChartWidget::updateRangeStatistics()
+{
+	int count = m_snapshot->signalCount();
+	for ( int ii=0; ii<count; ii++ )
+	{
+		const QVector< float > &signal = m_snapshot->vectorSignals.at( ii );
+		int first = 0,
+				last = 0;
+		if ( !getSignalRange( ii, m_recordFirstTime, m_recordLastTime, first, last ) )
+			continue;
+
+		SignalRangeStatistics statistics =
+			m_snapshot->vectorStatistics.at( ii ).range( signal, first, last );
+		emit qtsignalUpdateRangeStatistics( ii, statistics.mean, statistics.rms,
+											statistics.standardDeviation, statistics.area,
+											statistics.count );
+	}
+}  // end updateRangeStatistics
+
+
 // returns the index into the signal vectors corr to the given X screen coord
 int ChartWidget::getSignalIndex( int screenX )
 {
-	if ( !m_vectorScales.count() )
+	if ( !m_snapshot->signalCount() )
 		return 0;
 
 	// transform screen coordinates to NDC
@@ -853,19 +1056,19 @@ int ChartWidget::getSignalIndex( int screenX )
 
 	// find the data point corr to the screen location
 	// start w/ the visible portion of the range in case the user has
-	// zoomed in
+	// zoomed in, over the times at which any signal is shown
 	float maxNDC = m_screenToModel[0] + m_screenToModel[3],
 			minNDC = -m_screenToModel[0] + m_screenToModel[3];
-	int highIndex = qMin( (int) (maxNDC/m_xStep), m_numDataPoints ),
-			lowIndex = qMax( (int) (minNDC/m_xStep), 0 );
+	int highIndex = qMin( (int) floor( maxNDC/m_snapshot->xStep ), m_snapshot->lastTime() + 1 ),
+			lowIndex = qMax( (int) floor( minNDC/m_snapshot->xStep ), m_snapshot->firstTime() );
 
-	float dataX = m_xStep * highIndex;
+	float dataX = m_snapshot->xStep * highIndex;
 	while ( // fabs( dataX - x ) > 1.0e-3 &&
 			// lowIndex < highIndex &&
 			highIndex - lowIndex > 1 )
 	{
 		int testIndex = ( highIndex - lowIndex ) >> 1;
-		dataX = m_xStep * ( lowIndex + testIndex );
+		dataX = m_snapshot->xStep * ( lowIndex + testIndex );
 		qDebug() << "low: " << lowIndex << " high: " << highIndex << " dataX: " << dataX;
 		if ( x < dataX )
 			highIndex = lowIndex + testIndex;
@@ -873,23 +1076,53 @@ int ChartWidget::getSignalIndex( int screenX )
 			lowIndex += testIndex;
 	};
 
-	if ( lowIndex < 0 )
-		lowIndex = 0;
-	if ( lowIndex >= m_numDataPoints )
-		lowIndex = m_numDataPoints - 1;
-	return lowIndex;
+	return qBound( m_snapshot->firstTime(), lowIndex, m_snapshot->lastTime() );
 }  // end getSignalIndex
 
 
 
+// returns the range of data points of the given signal shown from firstTime to lastTime, which
+// differ by the time offset of the signal, or false if it has no data points shown there
+bool ChartWidget::getSignalRange( int signal, int firstTime, int lastTime, int &first, int &last ) const
+{
+	int offset = m_snapshot->timeOffsets.at( signal );
+	first = qMax( firstTime - offset, 0 );
+	last = qMin( lastTime - offset, m_snapshot->vectorSignals.at( signal ).size() - 1 );
+	return first <= last;
+}
+
+// finds the peak, or valley, of the given signal over the times swept while recording
+// returns false if none of the data points swept is there, otherwise sets its time, offset
+// included, and its value
+bool ChartWidget::findSweptExtremum( int signal, bool bMaximum, int &time, float &value ) const
+{
+	int first = 0,
+			last = 0;
+	if ( !getSignalRange( signal, m_recordFirstTime, m_recordLastTime, first, last ) )
+		return false;
+
+	const QVector< float > &data = m_snapshot->vectorSignals.at( signal );
+	int dataPoint = m_snapshot->vectorSummaries.at( signal ).findExtremum( data, first, last, bMaximum );
+
+	// a range of nothing but missing data points has no extremum
+	float extremum = data.at( dataPoint );
+	if ( extremum != extremum )
+		return false;
+
+	refineMaximum( signal, dataPoint, extremum, bMaximum );
+	time = dataPoint + m_snapshot->timeOffsets.at( signal );
+	value = extremum;
+	return true;
+}  // end findSweptExtremum
+
 // refine the peak and time by searching for the highest value in the vicinity of the given time
 void ChartWidget::refineMaximum( int signalId, int &time, float &signal, bool bMaximum ) const
 {
-	Q_ASSERT( signalId <= m_vectorSignals.count() );
+	Q_ASSERT( signalId <= m_snapshot->vectorSignals.count() );
 
 	// search vicinity data points to the right and to the left
 	int vicinity = 25;
-	const QVector< float > *pSignal = &m_vectorSignals.at( signalId );
+	const QVector< float > *pSignal = &m_snapshot->vectorSignals.at( signalId );
 	float maxSignal = pSignal->at( time );
 	int maxTime = time;
 	int startTime = qMax( 0, time - vicinity ),
@@ -936,8 +1169,8 @@ void ChartWidget::highlightPeak( int signalIndex, int time, double signal )
 		m_lastPeakY = m_peakY;
 	}
 
-	m_peakX = time * m_xStep;
-	m_peakY = signal * m_vectorScales.at( signalIndex );
+	m_peakX = time * m_snapshot->xStep;
+	m_peakY = signal * m_snapshot->scale( signalIndex );
 }
 
 // highlight the current and last valleys
@@ -950,7 +1183,7 @@ void ChartWidget::highlightValley( int signalIndex, int time, double signal )
 		m_lastValleyY = m_valleyY;
 	}
 
-	m_valleyX = time * m_xStep;
-	m_valleyY = signal * m_vectorScales.at( signalIndex );
+	m_valleyX = time * m_snapshot->xStep;
+	m_valleyY = signal * m_snapshot->scale( signalIndex );
 }
 
@@ -0,0 +1,221 @@
+#include "chartbatchrenderer.h"
+#include "chartlayout.h"
+#include "signalloader.h"
+
+#include <QFile>
+#include <QPainter>
+#include <QColor>
+#include <QPointF>
+#include <QtConcurrent>
+
+#include <limits>
+
+
+ChartBatchRenderer::ChartBatchRenderer( int width, int height )  // def 400, 400
+	: m_width( width ),
+	  m_height( height ),
+	  m_format( Png ),
+	  m_pngQuality( 50 )
+{
+
+}
+
+int ChartBatchRenderer::render( const QVector< ChartRenderJob > &jobs )
+{
+	m_errors.clear();
+
+	// every job writes its own error, if any, so the threads never share anything
+	QVector< QString > jobErrors( jobs.count() );
+	QString *pErrors = jobErrors.data();
+	QVector<int> indexes( jobs.count() );
+	for ( int ii=0; ii<jobs.count(); ii++ )
+		indexes[ ii ] = ii;
+
+	QtConcurrent::blockingMap( indexes, [&]( int job )
+	{
+		QImage image;
+		QString sError;
+		if ( !renderChart( jobs.at( job ).signalFiles, image, sError ) ||
+			 !writeImage( image, jobs.at( job ).outputFile, sError ) )
+			pErrors[ job ] = sError;
+	} );
+
+	int written = 0;
+	for ( int ii=0; ii<jobs.count(); ii++ )
+	{
+		if ( jobErrors.at( ii ).isEmpty() )
+			written++;
+		else
+			m_errors.append( jobErrors.at( ii ) );
+	}
+	return written;
+}  // end render
+
+bool ChartBatchRenderer::renderChart( const QStringList &signalFiles, QImage &image, QString &sError ) const
+{
+	// load the signals the way ChartWidget::addSignalFile() does, from the sidecar cache if the
+	// file has an up to date one
+	SignalFileReader reader( m_fileReader );
+	QVector< QVector<float> > vectorSignals;
+	QVector<float> scales;
+	for ( const QString &filename : signalFiles )
+	{
+		QVector< QVector<float> > columns;
+		QVector< SignalSummary > summaries;
+		// a batch of thumbnails reads each file once, so it uses the caches already there but
+		// writes none, those of compressed files being many times their size
+		reader.setExpectedDataPoints( vectorSignals.isEmpty() ? 0 : vectorSignals.first().size() );
+		if ( !SignalLoader::readFile( filename, reader, columns, summaries, sError, false ) )
+			return false;
+		for ( const SignalSummary &summary : summaries )
+			scales.push_back( summary.scale() );
+
+		if ( vectorSignals.count() + columns.count() > ChartLayout::s_maxSignals )
+		{
+			sError = QString( "Too many signals in file for the number of signal colors. Ignored: " ).append( filename );
+			return false;
+		}
+
+		if ( !vectorSignals.isEmpty() &&
+			 columns.first().size() != vectorSignals.first().size() )
+		{
+			sError = QString( "Number of data points is not the same as that of previously loaded files. Ignored: " ).append( filename );
+			return false;
+		}
+
+		vectorSignals += columns;
+	}  // end for each signal file
+
+	int tickSize = 0,
+			numTicks = 0;
+	float xTickStep = 0.0f,
+			xStep = 0.0f;
+	if ( !vectorSignals.isEmpty() )
+		ChartLayout::setTicks( vectorSignals.first().size(), tickSize, numTicks, xTickStep, xStep );
+
+	image = QImage( m_width, m_height, QImage::Format_ARGB32_Premultiplied );
+	image.fill( Qt::black );
+	QPainter painter( &image );
+
+	// the default view of ChartWidget, the model is translated by -1 on the X axis then projected
+	// by glOrtho w/ the aspect ratio correction of ChartWidget::updateAspectRatioWidthHeight()
+	float width = m_width,
+			height = m_height;
+	float aspectWidth = width > height ? width / height : 1.0f,
+			aspectHeight = height > width ? height / width : 1.0f;
+	auto screenX = [=]( float x ) { return ( ( x - 1.0f ) / aspectWidth + 1.0f ) * 0.5f * width; };
+	auto screenY = [=]( float y ) { return ( 1.0f - y / aspectHeight ) * 0.5f * height; };
+
+	// draw the axes and the ticks on the X axis
+	painter.setPen( QColor( Qt::white ) );
+	painter.drawLine( QPointF( screenX( 0.0f ), screenY( 0.0f ) ),
+					  QPointF( screenX( ChartLayout::s_xDomain ), screenY( 0.0f ) ) );
+	painter.drawLine( QPointF( screenX( 0.0f ), screenY( -ChartLayout::s_yDomain * 0.5f ) ),
+					  QPointF( screenX( 0.0f ), screenY( ChartLayout::s_yDomain * 0.5f ) ) );
+	for ( int ii=1; ii<numTicks; ii++ )
+	{
+		painter.drawLine( QPointF( screenX( xTickStep * ii ), screenY( -ChartLayout::s_tickHeight ) ),
+						  QPointF( screenX( xTickStep * ii ), screenY( ChartLayout::s_tickHeight ) ) );
+	}
+
+	// draw the signals, reduced to the min/max envelope of each pixel column when there are
+	// more data points than pixels, missing data points break the lines
+	QVector<float> minima( m_width ),
+			maxima( m_width );
+	QVector< QPointF > points;
+	auto drawPoints = [&]()
+	{
+		if ( points.size() > 1 )
+			painter.drawPolyline( points.constData(), points.size() );
+		points.clear();
+	};
+	for ( int ii=0; ii<vectorSignals.count(); ii++ )
+	{
+		const float *pColor = ChartLayout::s_signalColors[ ii ];
+		painter.setPen( QColor::fromRgbF( pColor[ 0 ], pColor[ 1 ], pColor[ 2 ] ) );
+
+		const QVector<float> &signal = vectorSignals.at( ii );
+		const float *pSignal = signal.constData();
+		int count = signal.size();
+		float scale = scales.at( ii );
+		points.clear();
+		if ( count <= 2 * m_width )
+		{
+			for ( int jj=0; jj<count; jj++ )
+			{
+				if ( pSignal[ jj ] != pSignal[ jj ] )
+					drawPoints();
+				else
+					points.push_back( QPointF( screenX( xStep * jj ), screenY( pSignal[ jj ] * scale ) ) );
+			}
+		}
+		else
+		{
+			minima.fill( std::numeric_limits<float>::max() );
+			maxima.fill( -std::numeric_limits<float>::max() );
+			float *pMinima = minima.data(),
+					*pMaxima = maxima.data();
+
+			// the column of a data point is linear in its index
+			float columnStep = screenX( xStep ) - screenX( 0.0f ),
+					firstColumn = screenX( 0.0f );
+			for ( int jj=0; jj<count; jj++ )
+			{
+				int column = (int) ( firstColumn + columnStep * jj );
+				if ( column < 0 || column >= m_width || pSignal[ jj ] != pSignal[ jj ] )
+					continue;
+				pMinima[ column ] = qMin( pMinima[ column ], pSignal[ jj ] );
+				pMaxima[ column ] = qMax( pMaxima[ column ], pSignal[ jj ] );
+			}
+
+			for ( int column=0; column<m_width; column++ )
+			{
+				if ( pMinima[ column ] > pMaxima[ column ] )
+				{
+					drawPoints();
+					continue;
+				}
+				points.push_back( QPointF( column + 0.5, screenY( pMinima[ column ] * scale ) ) );
+				points.push_back( QPointF( column + 0.5, screenY( pMaxima[ column ] * scale ) ) );
+			}
+		}
+
+		drawPoints();
+	}  // end for each signal
+
+	return true;
+}  // end renderChart
+
+bool ChartBatchRenderer::writeImage( const QImage &image, const QString &filename, QString &sError ) const
+{
+	if ( m_format == Png )
+	{
+		if ( !image.save( filename, "PNG", m_pngQuality ) )
+		{
+			sError = QString( "Could not write file: " ).append( filename );
+			return false;
+		}
+		return true;
+	}
+
+	// the chart is opaque, so premultiplied and straight alpha are the same
+	QImage rgba = image.convertToFormat( QImage::Format_RGBA8888 );
+	QFile file( filename );
+	if ( !file.open( QIODevice::WriteOnly ) )
+	{
+		sError = QString( "Could not write file: " ).append( filename );
+		return false;
+	}
+
+	qint64 rowSize = (qint64) rgba.width() * 4;
+	for ( int row=0; row<rgba.height(); row++ )
+	{
+		if ( file.write( (const char *) rgba.constScanLine( row ), rowSize ) != rowSize )
+		{
+			sError = QString( "Could not write file: " ).append( filename );
+			return false;
+		}
+	}
+
+	return true;
+}  // end writeImage
@@ -0,0 +1,66 @@
+#ifndef CHARTBATCHRENDERER_H
+#define CHARTBATCHRENDERER_H
+
+#include <QVector>
+#include <QString>
+#include <QStringList>
+#include <QImage>
+
+#include "signalfilereader.h"
+
+
+// one chart to render: the signal files it shows, in the order ChartWidget would load them, and
+// the file the image is written to
+struct ChartRenderJob
+{
+	QStringList signalFiles;
+	QString outputFile;
+};
+
+
+// renders charts of signal files straight to image files w/o a widget, a window or OpenGL
+// the charts have the layout of ChartWidget::draw() at its default zoom and pan: the same axes,
+// ticks, signal colors and signal scaling
+// the jobs are spread over the QtConcurrent thread pool and each one is painted on the CPU, so
+// this runs on servers w/o a display or a GPU
+class ChartBatchRenderer
+{
+public:
+	enum Format
+	{
+		Png,
+		RawRgba  // width * height * 4 bytes, top row first
+	};
+
+	ChartBatchRenderer( int width = 400, int height = 400 );
+
+	void setSize( int width, int height ) { m_width = width; m_height = height; }
+	void setFormat( Format format ) { m_format = format; }
+
+	// quality passed to QImage::save() for PNG files, lower compresses harder but more slowly
+	void setPngQuality( int quality ) { m_pngQuality = quality; }
+
+	// the delimiter and header settings the signal files are read with
+	void setFileReader( const SignalFileReader &fileReader ) { m_fileReader = fileReader; }
+
+	// renders all the jobs in parallel and returns the number of images written
+	// the reasons the other jobs failed are in errors()
+	int render( const QVector< ChartRenderJob > &jobs );
+	const QStringList &errors() const { return m_errors; }
+
+	// renders the chart of the given signal files into image
+	// returns false and sets sError if a file cannot be read or does not match the others
+	bool renderChart( const QStringList &signalFiles, QImage &image, QString &sError ) const;
+
+private:
+	bool writeImage( const QImage &image, const QString &filename, QString &sError ) const;
+
+	int m_width;
+	int m_height;
+	Format m_format;
+	int m_pngQuality;
+	SignalFileReader m_fileReader;
+	QStringList m_errors;
+};
+
+#endif // CHARTBATCHRENDERER_H
@@ -0,0 +1,77 @@
+#ifndef CHARTLAYOUT_H
+#define CHARTLAYOUT_H
+
+#include <QString>
+
+#include <cmath>
+#include <string>
+
+
+// layout of the chart in model coordinates, shared by ChartWidget::draw() and the batch renderer
+// the X axis runs from 0 to s_xDomain and the Y axis from -s_yDomain/2 to s_yDomain/2
+namespace ChartLayout
+{
+
+const float s_xDomain = 2.0f;
+const float s_yDomain = 1.0f;
+
+// fraction of the Y axis a signal covers at its largest magnitude
+const float s_yCoverage = 0.8f;
+
+// half the height of the tick marks on the X axis
+const float s_tickHeight = 0.1f;
+
+// this is an artificial limit based on the number of colors I defined for the signals
+const int s_maxSignals = 7;
+
+// the colors of the signals in the order they are loaded
+const float s_signalColors[ s_maxSignals ][ 3 ] =
+{
+	{ 1.0f, 0.0f, 0.0f },  // red
+	{ 0.0f, 1.0f, 0.0f },  // green
+	{ 0.0f, 0.0f, 1.0f },  // blue
+	{ 1.0f, 1.0f, 0.0f },  // yellow
+	{ 1.0f, 0.0f, 1.0f },  // purple
+	{ 1.0f, 0.5f, 0.0f },  // orange
+	{ 0.0f, 1.0f, 1.0f }   // cyan
+};
+
+// returns the scale factor that fits a signal w/ the given range into the chart
+inline float signalScale( float smallestY, float largestY )
+{
+	float signalScale = s_yDomain * .5 * s_yCoverage;
+	if ( fabs( smallestY ) > largestY )
+		signalScale /= fabs( smallestY );
+	else
+		signalScale /= largestY;
+	return signalScale;
+}
+
+// sets the X axis ticks for signals w/ the given number of data points
+inline void setTicks( int numDataPoints, int &tickSize, int &numTicks, float &xTickStep, float &xStep )
+{
+	// the X axis tick size is the number of data points between
+	// tick marks
+	QString sDataPoints =
+		QString::fromStdString( std::to_string( numDataPoints ) );
+	int length = sDataPoints.size();
+	tickSize = (int) floor( pow( 10, length-1 ) );
+	Q_ASSERT( tickSize > 0 );
+
+	// set the number of ticks for the graph
+	numTicks = numDataPoints / tickSize;
+	if ( numDataPoints % tickSize )
+		numTicks++;
+	Q_ASSERT( numTicks > 0 );
+
+	// set the distance between tick marks on the X axis
+	xTickStep = s_xDomain / numTicks;
+
+	// set the distance between data points on the X axis
+	xStep = xTickStep / tickSize;
+	Q_ASSERT( xStep > 0.0f );
+}  // end setTicks
+
+}  // end namespace ChartLayout
+
+#endif // CHARTLAYOUT_H
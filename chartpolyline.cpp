@@ -0,0 +1,181 @@
+#include "chartpolyline.h"
+
+#include <cmath>
+
+
+namespace
+{
+
+// longest a miter may get, in multiples of the half width, before sharp turns are cut short
+const float s_miterLimit = 4.0f;
+
+}  // end anonymous namespace
+
+
+ChartPolyline::ChartPolyline()
+	: m_width( 1.0f ),
+	  m_xPixel( 1.0f ),
+	  m_yPixel( 1.0f )
+{
+
+}
+
+void ChartPolyline::clear( float xPixel, float yPixel )
+{
+	m_xPixel = xPixel;
+	m_yPixel = yPixel;
+	m_points.clear();
+	m_starts.clear();
+	m_starts.push_back( 0 );
+}
+
+void ChartPolyline::addPoint( float x, float y )
+{
+	m_points.push_back( x );
+	m_points.push_back( y );
+}
+
+void ChartPolyline::breakLine()
+{
+	int count = m_points.size() / 2;
+	if ( m_starts.last() != count )
+		m_starts.push_back( count );
+}
+
+void ChartPolyline::draw()
+{
+	int count = m_points.size() / 2;
+	glLineWidth( m_width );
+	glEnableClientState( GL_VERTEX_ARRAY );
+	glVertexPointer( 2, GL_FLOAT, 0, m_points.constData() );
+	for ( int ii=0; ii<m_starts.size(); ii++ )
+	{
+		int first = m_starts.at( ii ),
+				last = ii + 1 < m_starts.size() ? m_starts.at( ii + 1 ) : count;
+		if ( last - first > 1 )
+			glDrawArrays( GL_LINE_STRIP, first, last - first );
+	}
+	glDisableClientState( GL_VERTEX_ARRAY );
+	glLineWidth( 1.0f );
+}
+
+void ChartPolyline::drawAntialiased( const float *pColor )
+{
+	// lines thinner than a pixel are drawn a pixel wide but w/ proportionally less coverage
+	float coreWidth = qMax( m_width * 0.5f - 0.5f, 0.0f ),
+			alpha = qMin( m_width, 1.0f );
+
+	m_vertices.clear();
+	m_colors.clear();
+	m_indices.clear();
+	int count = m_points.size() / 2;
+	for ( int ii=0; ii<m_starts.size(); ii++ )
+	{
+		expand( m_starts.at( ii ), ii + 1 < m_starts.size() ? m_starts.at( ii + 1 ) : count,
+				coreWidth, alpha, pColor );
+	}
+	if ( m_indices.isEmpty() )
+		return;
+
+	glEnable( GL_BLEND );
+	glBlendFunc( GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA );
+	glEnableClientState( GL_VERTEX_ARRAY );
+	glEnableClientState( GL_COLOR_ARRAY );
+	glVertexPointer( 2, GL_FLOAT, 0, m_vertices.constData() );
+	glColorPointer( 4, GL_FLOAT, 0, m_colors.constData() );
+	glDrawElements( GL_TRIANGLES, m_indices.size(), GL_UNSIGNED_INT, m_indices.constData() );
+	glDisableClientState( GL_COLOR_ARRAY );
+	glDisableClientState( GL_VERTEX_ARRAY );
+	glDisable( GL_BLEND );
+}  // end drawAntialiased
+
+// adds the triangles of the polyline made of points [first, last)
+// every point becomes four vertices across the line, the outer ones transparent, and every
+// segment the six triangles between the vertices of its two points
+void ChartPolyline::expand( int first, int last, float coreWidth, float alpha, const float *pColor )
+{
+	if ( last - first < 2 )
+		return;
+
+	const float *pPoints = m_points.constData() + 2 * first;
+	int numPoints = last - first;
+	GLuint base = m_vertices.size() / 2;
+
+	// normals are taken in pixels so the width is the same along X and Y whatever the zoom
+	float previousX = 0.0f,
+			previousY = 1.0f;
+	for ( int ii=0; ii<numPoints; ii++ )
+	{
+		float nextX = previousX,
+				nextY = previousY;
+		if ( ii + 1 < numPoints )
+		{
+			float dx = ( pPoints[ 2 * ii + 2 ] - pPoints[ 2 * ii ] ) / m_xPixel,
+					dy = ( pPoints[ 2 * ii + 3 ] - pPoints[ 2 * ii + 1 ] ) / m_yPixel;
+			float length = sqrtf( dx * dx + dy * dy );
+
+			// segments shorter than a rounding error keep the normal of the one before
+			if ( length > 1e-6f )
+			{
+				nextX = -dy / length;
+				nextY = dx / length;
+			}
+		}
+		if ( !ii )
+		{
+			previousX = nextX;
+			previousY = nextY;
+		}
+
+		// the miter is along the sum of the normals of the two segments, and longer the sharper
+		// the turn so that the sides of the line stay parallel to the segments
+		float miterX = previousX + nextX,
+				miterY = previousY + nextY;
+		float miterLength = sqrtf( miterX * miterX + miterY * miterY ),
+				scale = 1.0f;
+		if ( miterLength > 1e-6f )
+		{
+			miterX /= miterLength;
+			miterY /= miterLength;
+			scale = 1.0f / qMax( miterX * nextX + miterY * nextY, 1.0f / s_miterLimit );
+		}
+		else
+		{
+			// the line turns back on itself
+			miterX = nextX;
+			miterY = nextY;
+		}
+
+		float x = pPoints[ 2 * ii ],
+				y = pPoints[ 2 * ii + 1 ];
+		float offsets[ 4 ] = { coreWidth + 1.0f, coreWidth, -coreWidth, -coreWidth - 1.0f },
+				alphas[ 4 ] = { 0.0f, alpha, alpha, 0.0f };
+		for ( int jj=0; jj<4; jj++ )
+		{
+			m_vertices.push_back( x + miterX * offsets[ jj ] * scale * m_xPixel );
+			m_vertices.push_back( y + miterY * offsets[ jj ] * scale * m_yPixel );
+			m_colors.push_back( pColor[ 0 ] );
+			m_colors.push_back( pColor[ 1 ] );
+			m_colors.push_back( pColor[ 2 ] );
+			m_colors.push_back( alphas[ jj ] );
+		}
+
+		if ( ii )
+		{
+			GLuint before = base + 4 * ( ii - 1 ),
+					after = before + 4;
+			for ( GLuint jj=0; jj<3; jj++ )
+			{
+				m_indices.push_back( before + jj );
+				m_indices.push_back( after + jj );
+				m_indices.push_back( after + jj + 1 );
+				m_indices.push_back( before + jj );
+				m_indices.push_back( after + jj + 1 );
+				m_indices.push_back( before + jj + 1 );
+			}
+		}
+
+		previousX = nextX;
+		previousY = nextY;
+	}  // end for each point
+}  // end expand
@@ -0,0 +1,53 @@
+#ifndef CHARTPOLYLINE_H
+#define CHARTPOLYLINE_H
+
+#include <QOpenGLWidget>
+#include <QVector>
+
+
+// polylines of a signal in model coordinates, drawn either as plain lines or anti-aliased
+// an anti-aliased line is expanded on the CPU into a strip of triangles w/ a one pixel wide fringe
+// on each side whose alpha falls off to 0, which approximates the coverage of the line by each
+// pixel, and w/ mitered joins, so it costs about as much as plain lines and needs neither
+// GL_LINE_SMOOTH nor multisampling
+class ChartPolyline
+{
+public:
+	ChartPolyline();
+
+	// width of the lines in pixels
+	void setWidth( float width ) { m_width = width; }
+	float width() const { return m_width; }
+
+	// starts over w/ no points, xPixel and yPixel being the size of a pixel in model coordinates
+	void clear( float xPixel, float yPixel );
+
+	void addPoint( float x, float y );
+
+	// ends the current polyline, the next point starts a new one
+	void breakLine();
+
+	// draws the polylines in the current color w/ GL_LINE_STRIP
+	void draw();
+
+	// draws the polylines anti-aliased in the given color
+	void drawAntialiased( const float *pColor );
+
+private:
+	void expand( int first, int last, float coreWidth, float alpha, const float *pColor );
+
+	float m_width;
+	float m_xPixel;
+	float m_yPixel;
+
+	// x, y pairs, and the index of the 1st point of every polyline
+	QVector<float> m_points;
+	QVector<int> m_starts;
+
+	// triangles of the anti-aliased polylines
+	QVector<float> m_vertices;
+	QVector<float> m_colors;
+	QVector<GLuint> m_indices;
+};
+
+#endif // CHARTPOLYLINE_H
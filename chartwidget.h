@@ -0,0 +1,189 @@
+#ifndef CHARTWIDGET_H
+#define CHARTWIDGET_H
+
+#include <QOpenGLWidget>
+#include <QVector>
+#include <QString>
+#include <QPoint>
+#include <QMouseEvent>
+#include <QKeyEvent>
+#include <QFutureWatcher>
+
+#include <memory>
+
+#include "signalfilereader.h"
+#include "signalsummary.h"
+#include "signalstore.h"
+#include "signaldensity.h"
+#include "chartpolyline.h"
+#include "signalcorrelation.h"
+
+
+class ChartWidget : public QOpenGLWidget
+{
+	Q_OBJECT
+
+public:
+	ChartWidget( QWidget *parent = 0 );
+	~ChartWidget();
+
+	QSize minimumSizeHint() const;
+	QSize sizeHint() const;
+
+	// loads every column of the given file as a separate signal
+	bool addSignalFile( QString &filename );
+
+	// the signals shown by this chart
+	// several charts may show the same store, each w/ its own zoom and pan, in which case the
+	// signals are loaded, and held in memory, only once
+	const std::shared_ptr< SignalStore > &signalStore() const { return m_store; }
+	void setSignalStore( const std::shared_ptr< SignalStore > &store );
+
+	// a time locked chart follows the X axis of the charts whose qtsignalTimeViewChanged() is
+	// connected to its qtslotSetTimeView()
+	void setTimeLocked( bool bTimeLocked ) { m_bTimeLocked = bTimeLocked; }
+	bool timeLocked() const { return m_bTimeLocked; }
+
+	// the delimiter and header settings the signal files are read w/
+	const SignalFileReader &fileReader() const { return m_fileReader; }
+
+	// column delimiter of the signal files, '\0' detects it from the first data line
+	void setDelimiter( char delimiter ) { m_fileReader.setDelimiter( delimiter ); }
+	// true if the signal files start w/ a row of column names
+	void setHeaderRow( bool bHeaderRow ) { m_fileReader.setHeaderRow( bHeaderRow ); }
+
+	// width of the signal lines in pixels
+	void setLineWidth( float width ) { m_polyline.setWidth( width ); update(); }
+	float lineWidth() const { return m_polyline.width(); }
+
+public slots:
+	void qtslotFileChanged( QString &filename );
+	void qtslotSnapshotChanged();
+
+	// sets the level whose crossings are jumped to w/ shift and the arrow keys
+	void qtslotSetEventThreshold( double threshold );
+
+	// shows the X axis range centered on centerX w/ the given half width, in model coordinates,
+	// if the chart is time locked
+	void qtslotSetTimeView( float centerX, float halfWidth );
+
+	// finds the lag between the given signals on a worker thread and emits
+	// qtsignalCorrelationFound(), then shows the second signal shifted by that lag if bAlign
+	// is true, a correlation still running is left to finish but its result is ignored
+	void qtslotCorrelate( int first, int second, bool bAlign );
+
+private slots:
+	void qtslotCorrelationFinished();
+
+signals:
+	void qtsignalUpdateValue( int signal, float value, int time );
+	void qtsignalUpdatePeakValue( float value, int time );
+	void qtsignalUpdateRangeStatistics( int signal, float mean, float rms, float standardDeviation,
+										float area, int count );
+	void qtsignalStartRecordingPeakValues( bool bPeak );
+	void qtsignalDisplayArbitraryDeltas( float value, int time );
+
+	// emitted when the X axis range is zoomed or panned by the user
+	void qtsignalTimeViewChanged( float centerX, float halfWidth );
+
+	// the first signal lags the second by lag data points, w/ the given normalized correlation
+	void qtsignalCorrelationFound( int first, int second, int lag, float coefficient );
+
+protected:
+	void initializeGL();
+	void paintGL();
+	void resizeGL( int width, int height );
+
+	void mousePressEvent( QMouseEvent *event );
+	void mouseReleaseEvent( QMouseEvent *event );
+	void mouseMoveEvent( QMouseEvent *event );
+	void keyPressEvent( QKeyEvent *event );
+
+private:
+	bool readDataFile( const QString &filename );
+
+	void setProjectionMatrix( int width, int height, float zoomFactor );
+	void updateAspectRatioWidthHeight( int width, int height );
+	void updateInverseTransform();
+	void setModelViewMatrix();
+	void getInverseProjectionMatrix( float inverseProject[] );
+	void draw();
+	void drawDensity();
+	void getVisibleRange( int &firstTime, int &lastTime ) const;
+
+	void highlightSelectedDataPoint( int signal );
+	void updateSignalValues( int screenX );
+	void updateValuesAtTime();
+	void centerOnTime( int time );
+	void timeViewChanged();
+	int getSignalIndex( int screenX );
+	bool getSignalRange( int signal, int firstTime, int lastTime, int &first, int &last ) const;
+	bool findSweptExtremum( int signal, bool bMaximum, int &time, float &value ) const;
+	void refineMaximum( int signalId, int &time, float &signal, bool bMaximum ) const;
+	void highlightPeak( int signalIndex, int time, double signal );
+	void highlightValley( int signalIndex, int time, double signal );
+	void updateRangeStatistics();
+
+	// signal data, the snapshot is the version of the store being displayed
+	SignalFileReader m_fileReader;
+	std::shared_ptr< SignalStore > m_store;
+	SignalSnapshotPtr m_snapshot;
+
+	// chart layout
+	int m_dimensions;
+	float m_xDomain;
+	float m_yDomain;
+	float m_yCoverage;
+
+	// view
+	float m_aspectRatioWidth;
+	float m_aspectRatioHeight;
+	float m_zoomFactor;
+	float m_xPan;
+	float m_yPan;
+	float m_near;
+	float m_far;
+	float m_screenToModel[ 16 ];
+	bool m_bTimeLocked;
+	bool m_smoothOn;
+	ChartPolyline m_polyline;
+
+	// density display, the hits of every signal are kept between frames and only the new data
+	// points or columns are counted
+	bool m_densityOn;
+	quint64 m_densityGeneration;
+	QVector< SignalDensity > m_densities;
+	QVector< uchar > m_densityPixels;
+	GLuint m_densityTexture;
+
+	// cross-correlation running in the background
+	// along w/ the store and generation of the signals it runs on, whose result no longer
+	// applies once they are replaced
+	QFutureWatcher< SignalLag > m_correlationWatcher;
+	std::weak_ptr< SignalStore > m_correlationStore;
+	quint64 m_correlationGeneration;
+	bool m_bAlignOnCorrelation;
+
+	// peaks and valleys
+	bool m_recordingPeak;
+	bool m_recordingValley;
+	float m_currentPeak;
+	float m_currentValley;
+	int m_peakTime;
+	int m_recordFirstTime;
+	int m_recordLastTime;
+	float m_peakX;
+	float m_peakY;
+	float m_lastPeakX;
+	float m_lastPeakY;
+	float m_valleyX;
+	float m_valleyY;
+	float m_lastValleyX;
+	float m_lastValleyY;
+
+	// mouse
+	QPoint lastPos;
+	int m_timeAtMouse;
+};
+
+#endif // CHARTWIDGET_H
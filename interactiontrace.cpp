@@ -0,0 +1,363 @@
+#include "interactiontrace.h"
+#include "chartwidget.h"
+#include "signalloader.h"
+
+#include <QCoreApplication>
+#include <QMouseEvent>
+#include <QKeyEvent>
+#include <QResizeEvent>
+
+#include <algorithm>
+
+
+namespace
+{
+
+const char *typeName( QEvent::Type type )
+{
+	switch ( type )
+	{
+	case QEvent::MouseButtonPress:
+		return "press";
+	case QEvent::MouseButtonRelease:
+		return "release";
+	case QEvent::MouseMove:
+		return "move";
+	case QEvent::KeyPress:
+		return "key";
+	case QEvent::Resize:
+		return "resize";
+	default:
+		return "other";
+	}
+}
+
+}  // end anonymous namespace
+
+
+InteractionRecorder::InteractionRecorder( ChartWidget *chart, QObject *parent )  // def NULL
+	: QObject( parent ),
+	  m_chart( chart )
+{
+	m_chart->installEventFilter( this );
+}
+
+InteractionRecorder::~InteractionRecorder()
+{
+	stop();
+}
+
+bool InteractionRecorder::start( const QString &filename, const QStringList &signalFiles, QString &sError )
+{
+	stop();
+
+	m_file.setFileName( filename );
+	if ( !m_file.open( QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text ) )
+	{
+		sError = QString( "Could not create trace file " ).append( filename );
+		return false;
+	}
+
+	// the data set the events are played against
+	m_stream.setDevice( &m_file );
+	m_stream << "# chart interaction trace\n";
+	m_stream << "delimiter " << (int) m_chart->fileReader().delimiter() << "\n";
+	m_stream << "header " << ( m_chart->fileReader().headerRow() ? 1 : 0 ) << "\n";
+	for ( const QString &signalFile : signalFiles )
+		m_stream << "file " << signalFile << "\n";
+	m_stream << "size " << m_chart->width() << " " << m_chart->height() << "\n";
+
+	m_clock.start();
+	return true;
+}  // end start
+
+void InteractionRecorder::stop()
+{
+	if ( !recording() )
+		return;
+
+	m_stream.flush();
+	m_stream.setDevice( 0 );
+	m_file.close();
+}
+
+bool InteractionRecorder::eventFilter( QObject *object, QEvent *event )
+{
+	if ( object != m_chart || !recording() )
+		return false;
+
+	qint64 time = m_clock.nsecsElapsed() / 1000;
+	switch ( event->type() )
+	{
+	case QEvent::MouseButtonPress:
+	case QEvent::MouseButtonRelease:
+	{
+		QMouseEvent *pMouseEvent = static_cast< QMouseEvent * >( event );
+		m_stream << time << " " << typeName( event->type() ) << " "
+				 << pMouseEvent->x() << " " << pMouseEvent->y() << " "
+				 << (int) pMouseEvent->button() << " " << (int) pMouseEvent->buttons() << " "
+				 << (int) pMouseEvent->modifiers() << "\n";
+		break;
+	}
+
+	case QEvent::MouseMove:
+	{
+		QMouseEvent *pMouseEvent = static_cast< QMouseEvent * >( event );
+		m_stream << time << " move " << pMouseEvent->x() << " " << pMouseEvent->y() << " "
+				 << (int) pMouseEvent->buttons() << " " << (int) pMouseEvent->modifiers() << "\n";
+		break;
+	}
+
+	case QEvent::KeyPress:
+	{
+		QKeyEvent *pKeyEvent = static_cast< QKeyEvent * >( event );
+		m_stream << time << " key " << pKeyEvent->key() << " " << (int) pKeyEvent->modifiers() << "\n";
+		break;
+	}
+
+	case QEvent::Resize:
+	{
+		QResizeEvent *pResizeEvent = static_cast< QResizeEvent * >( event );
+		m_stream << time << " resize " << pResizeEvent->size().width() << " "
+				 << pResizeEvent->size().height() << "\n";
+		break;
+	}
+
+	default:
+		break;
+	}
+
+	// the chart still handles the event
+	return false;
+}  // end eventFilter
+
+
+InteractionReplayer::InteractionReplayer()
+	: m_size( 400, 400 )
+{
+
+}
+
+bool InteractionReplayer::load( const QString &filename, QString &sError )
+{
+	m_signalFiles.clear();
+	m_events.clear();
+
+	QFile file( filename );
+	if ( !file.open( QIODevice::ReadOnly | QIODevice::Text ) )
+	{
+		sError = QString( "Could not open trace file " ).append( filename );
+		return false;
+	}
+
+	QTextStream stream( &file );
+	int lineNumber = 0;
+	while ( !stream.atEnd() )
+	{
+		QString line = stream.readLine();
+		lineNumber++;
+		if ( line.isEmpty() || line.startsWith( '#' ) )
+			continue;
+
+		// file names may have spaces
+		if ( line.startsWith( "file " ) )
+		{
+			m_signalFiles.append( line.mid( 5 ) );
+			continue;
+		}
+
+		// lines of nothing but spaces are blank too
+		QStringList fields = line.split( ' ', Qt::SkipEmptyParts );
+		if ( fields.isEmpty() )
+			continue;
+
+		bool bOk = true;
+		auto number = [&]( int index )
+		{
+			bool bNumber = false;
+			int value = fields.at( index ).toInt( &bNumber );
+			bOk = bOk && bNumber;
+			return value;
+		};
+
+		int count = fields.count();
+		if ( fields.first() == "delimiter" && count == 2 )
+			m_fileReader.setDelimiter( (char) number( 1 ) );
+		else if ( fields.first() == "header" && count == 2 )
+			m_fileReader.setHeaderRow( number( 1 ) != 0 );
+		else if ( fields.first() == "size" && count == 3 )
+			m_size = QSize( number( 1 ), number( 2 ) );
+		else if ( count >= 2 )
+		{
+			TraceEvent event = {};
+			event.time = fields.first().toLongLong( &bOk );
+
+			const QString &type = fields.at( 1 );
+			if ( ( type == "press" || type == "release" ) && count == 7 )
+			{
+				event.type = type == "press" ? QEvent::MouseButtonPress : QEvent::MouseButtonRelease;
+				event.position = QPoint( number( 2 ), number( 3 ) );
+				event.button = number( 4 );
+				event.buttons = number( 5 );
+				event.modifiers = number( 6 );
+			}
+			else if ( type == "move" && count == 6 )
+			{
+				event.type = QEvent::MouseMove;
+				event.position = QPoint( number( 2 ), number( 3 ) );
+				event.buttons = number( 4 );
+				event.modifiers = number( 5 );
+			}
+			else if ( type == "key" && count == 4 )
+			{
+				event.type = QEvent::KeyPress;
+				event.key = number( 2 );
+				event.modifiers = number( 3 );
+			}
+			else if ( type == "resize" && count == 4 )
+			{
+				event.type = QEvent::Resize;
+				event.position = QPoint( number( 2 ), number( 3 ) );
+			}
+			else
+				bOk = false;
+
+			m_events.push_back( event );
+		}
+		else
+			bOk = false;
+
+		if ( !bOk )
+		{
+			sError = QString( "Trace is formatted incorrectly at line %1" ).arg( lineNumber );
+			return false;
+		}
+	}  // end for each line
+
+	return true;
+}  // end load
+
+// loads the signal files the way ChartWidget::addSignalFile() does, but returns the errors
+// instead of displaying them since nobody is there to close a message box
+bool InteractionReplayer::loadSignals( ChartWidget *chart, QString &sError ) const
+{
+	for ( const QString &filename : m_signalFiles )
+	{
+		if ( !SignalLoader::addFile( filename, m_fileReader, *chart->signalStore(), sError ) )
+			return false;
+	}
+
+	return true;
+}
+
+bool InteractionReplayer::replay( ChartWidget *chart, QString &sError )
+{
+	m_timings.clear();
+
+	chart->setDelimiter( m_fileReader.delimiter() );
+	chart->setHeaderRow( m_fileReader.headerRow() );
+	if ( !loadSignals( chart, sError ) )
+		return false;
+
+	// settle the layout of the chart and render a 1st frame outside of the timings
+	chart->resize( m_size );
+	chart->show();
+	QCoreApplication::processEvents();
+	chart->grabFramebuffer();
+
+	QElapsedTimer timer;
+	for ( const TraceEvent &event : m_events )
+	{
+		ReplayTiming timing;
+		timer.start();
+		switch ( event.type )
+		{
+		case QEvent::MouseButtonPress:
+		case QEvent::MouseButtonRelease:
+		case QEvent::MouseMove:
+		{
+			QMouseEvent mouseEvent( event.type, QPointF( event.position ),
+									(Qt::MouseButton) event.button,
+									Qt::MouseButtons( event.buttons ),
+									Qt::KeyboardModifiers( event.modifiers ) );
+			QCoreApplication::sendEvent( chart, &mouseEvent );
+			break;
+		}
+
+		case QEvent::KeyPress:
+		{
+			QKeyEvent keyEvent( QEvent::KeyPress, event.key, Qt::KeyboardModifiers( event.modifiers ) );
+			QCoreApplication::sendEvent( chart, &keyEvent );
+			break;
+		}
+
+		case QEvent::Resize:
+			chart->resize( event.position.x(), event.position.y() );
+			break;
+
+		default:
+			break;
+		}
+		timing.handlingNs = timer.nsecsElapsed();
+
+		// render the frame the event asked for, reading it back included
+		timer.start();
+		chart->grabFramebuffer();
+		timing.frameNs = timer.nsecsElapsed();
+
+		m_timings.push_back( timing );
+	}  // end for each event
+
+	return true;
+}  // end replay
+
+qint64 InteractionReplayer::latencyPercentile( double fraction ) const
+{
+	if ( m_timings.isEmpty() )
+		return 0;
+
+	QVector<qint64> latencies;
+	for ( const ReplayTiming &timing : m_timings )
+		latencies.push_back( timing.handlingNs + timing.frameNs );
+	std::sort( latencies.begin(), latencies.end() );
+	return latencies.at( qMin( (int) ( fraction * latencies.size() ), latencies.size() - 1 ) );
+}
+
+void InteractionReplayer::report( QTextStream &stream ) const
+{
+	// count, mean, median, 95th percentile and maximum in milliseconds
+	auto statistics = []( QVector<qint64> &times )
+	{
+		std::sort( times.begin(), times.end() );
+		double sum = 0.0;
+		for ( qint64 time : times )
+			sum += time;
+		auto milliseconds = []( double ns ) { return QString::number( ns / 1e6, 'f', 3 ); };
+		return QString( "mean %1 p50 %2 p95 %3 max %4" )
+				.arg( milliseconds( sum / times.size() ) )
+				.arg( milliseconds( times.at( times.size() / 2 ) ) )
+				.arg( milliseconds( times.at( qMin( (int) ( 0.95 * times.size() ), times.size() - 1 ) ) ) )
+				.arg( milliseconds( times.last() ) );
+	};
+
+	const QEvent::Type types[] = { QEvent::MouseButtonPress, QEvent::MouseButtonRelease,
+								   QEvent::MouseMove, QEvent::KeyPress, QEvent::Resize };
+	for ( QEvent::Type type : types )
+	{
+		QVector<qint64> handling,
+				frames;
+		for ( int ii=0; ii<m_events.size() && ii<m_timings.size(); ii++ )
+		{
+			if ( m_events.at( ii ).type != type )
+				continue;
+			handling.push_back( m_timings.at( ii ).handlingNs );
+			frames.push_back( m_timings.at( ii ).frameNs );
+		}
+		if ( handling.isEmpty() )
+			continue;
+
+		stream << typeName( type ) << " count " << handling.size()
+			   << " handling ms " << statistics( handling )
+			   << " frame ms " << statistics( frames ) << "\n";
+	}
+}  // end report
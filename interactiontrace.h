@@ -0,0 +1,125 @@
+#ifndef INTERACTIONTRACE_H
+#define INTERACTIONTRACE_H
+
+#include <QObject>
+#include <QVector>
+#include <QString>
+#include <QStringList>
+#include <QSize>
+#include <QPoint>
+#include <QEvent>
+#include <QFile>
+#include <QTextStream>
+#include <QElapsedTimer>
+
+#include "signalfilereader.h"
+
+class ChartWidget;
+
+
+// a trace is a text file that starts w/ the data set the chart was showing, one setting per line:
+//   delimiter <character code>
+//   header <0 or 1>
+//   file <signal file>
+//   size <width> <height>
+// followed by one input event per line, w/ the microseconds since the recording started:
+//   <time> press <x> <y> <button> <buttons> <modifiers>
+//   <time> release <x> <y> <button> <buttons> <modifiers>
+//   <time> move <x> <y> <buttons> <modifiers>
+//   <time> key <key> <modifiers>
+//   <time> resize <width> <height>
+// lines starting w/ '#' are comments
+
+
+// records the input events of a chart into a trace file
+// the recorder filters the events of the chart w/o consuming them, so it can be left installed
+// in production builds and only started when a latency problem needs to be captured
+class InteractionRecorder : public QObject
+{
+	Q_OBJECT
+
+public:
+	InteractionRecorder( ChartWidget *chart, QObject *parent = 0 );
+	~InteractionRecorder();
+
+	// starts a trace of the chart showing the given signal files, which must be the files
+	// loaded into it, in the same order
+	// returns false and sets sError if the trace file could not be created
+	bool start( const QString &filename, const QStringList &signalFiles, QString &sError );
+	void stop();
+	bool recording() const { return m_file.isOpen(); }
+
+protected:
+	bool eventFilter( QObject *object, QEvent *event );
+
+private:
+	ChartWidget *m_chart;
+	QFile m_file;
+	QTextStream m_stream;
+	QElapsedTimer m_clock;
+};
+
+
+// one input event of a trace
+struct TraceEvent
+{
+	qint64 time;  // microseconds since the recording started
+	QEvent::Type type;
+	QPoint position;  // or the new size of a resize
+	int button;
+	int buttons;
+	int modifiers;
+	int key;
+};
+
+// how long the chart took to handle an event of a trace, and then to render a frame
+struct ReplayTiming
+{
+	qint64 handlingNs;
+	qint64 frameNs;
+};
+
+
+// replays a trace against a chart, one event at a time and w/o the event loop in between,
+// so that the same trace always does the same work no matter how fast the machine is
+// every event is followed by a frame rendered into the framebuffer of the chart, which lets
+// this run on a machine w/o a display under the offscreen platform
+class InteractionReplayer
+{
+public:
+	InteractionReplayer();
+
+	// returns false and sets sError if the trace could not be read or is formatted incorrectly
+	bool load( const QString &filename, QString &sError );
+
+	const QStringList &signalFiles() const { return m_signalFiles; }
+	const QSize &size() const { return m_size; }
+	const QVector< TraceEvent > &events() const { return m_events; }
+
+	// loads the signal files of the trace into the store of the chart, sizes the chart and
+	// sends it the events of the trace, timing each one
+	// returns false and sets sError if the signal files could not be loaded
+	bool replay( ChartWidget *chart, QString &sError );
+
+	// one timing per event of the last replay
+	const QVector< ReplayTiming > &timings() const { return m_timings; }
+
+	// returns the latency, handling plus frame, below which the given fraction of the events was
+	// handled and rendered
+	qint64 latencyPercentile( double fraction ) const;
+
+	// writes the count, mean, median, 95th percentile and maximum of the handling and frame
+	// times of every type of event
+	void report( QTextStream &stream ) const;
+
+private:
+	bool loadSignals( ChartWidget *chart, QString &sError ) const;
+
+	SignalFileReader m_fileReader;
+	QStringList m_signalFiles;
+	QSize m_size;
+	QVector< TraceEvent > m_events;
+	QVector< ReplayTiming > m_timings;
+};
+
+#endif // INTERACTIONTRACE_H
@@ -0,0 +1,294 @@
+#include "signalcache.h"
+#include "signalmemory.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QSaveFile>
+
+#include <cstring>
+
+
+namespace
+{
+
+const char s_magic[ 8 ] = { 'S', 'I', 'G', 'C', 'A', 'C', 'H', 'E' };
+const quint32 s_version = 1;
+
+// number of bytes hashed at the start and end of the source file, and at each sample between
+const qint64 s_hashEdgeSize = 64 * 1024;
+const qint64 s_hashSampleSize = 4 * 1024;
+const int s_hashSamples = 16;
+
+struct CacheHeader
+{
+	char magic[ 8 ];
+	quint32 version;
+	quint32 numColumns;
+	qint64 sourceSize;
+	qint64 sourceModified;
+	quint64 sourceHash;
+	qint32 delimiter;
+	qint32 bHeaderRow;
+	qint32 numDataPoints;
+	qint32 numLevels;
+};
+
+struct ColumnHeader
+{
+	float smallestY;
+	float largestY;
+	float scale;
+	qint32 reserved;
+};
+
+// FNV-1a
+void hashBytes( quint64 &hash, const char *p, qint64 size )
+{
+	for ( qint64 ii=0; ii<size; ii++ )
+	{
+		hash ^= (uchar) p[ ii ];
+		hash *= Q_UINT64_C( 1099511628211 );
+	}
+}
+
+// fills in the source part of the header for the given file
+// the hash covers the start and end of the file and evenly spaced samples in between, so checking
+// a cache costs a few reads instead of a pass over the file, while size and modification time
+// already catch ordinary edits
+bool setSourceKey( const QString &filename, CacheHeader &header )
+{
+	QFile file( filename );
+	if ( !file.open( QIODevice::ReadOnly ) )
+		return false;
+
+	QFileInfo info( file );
+	header.sourceSize = file.size();
+	header.sourceModified = info.lastModified().toMSecsSinceEpoch();
+	header.sourceHash = Q_UINT64_C( 14695981039346656037 );
+
+	QVector<qint64> offsets;
+	offsets.push_back( 0 );
+	for ( int ii=1; ii<=s_hashSamples; ii++ )
+		offsets.push_back( header.sourceSize * ii / ( s_hashSamples + 1 ) );
+	offsets.push_back( qMax( (qint64) 0, header.sourceSize - s_hashEdgeSize ) );
+
+	QByteArray buffer;
+	for ( int ii=0; ii<offsets.count(); ii++ )
+	{
+		qint64 size = ( ii == 0 || ii == offsets.count() - 1 ) ? s_hashEdgeSize : s_hashSampleSize;
+		if ( !file.seek( offsets.at( ii ) ) )
+			return false;
+		buffer = file.read( size );
+		hashBytes( header.sourceHash, buffer.constData(), buffer.size() );
+	}
+
+	return true;
+}  // end setSourceKey
+
+// returns the number of blocks of each level of the pyramid of a signal w/ the given number of samples
+QVector<int> levelBlocks( int numDataPoints )
+{
+	QVector<int> blocks;
+	int numBlocks = ( numDataPoints + SignalSummary::s_baseBlockSize - 1 ) / SignalSummary::s_baseBlockSize;
+	blocks.push_back( numBlocks );
+	while ( numBlocks > 1 )
+	{
+		numBlocks = ( numBlocks + 1 ) / 2;
+		blocks.push_back( numBlocks );
+	}
+	return blocks;
+}
+
+// returns the size in bytes of the samples and pyramid of one column
+qint64 columnSize( int numDataPoints, const QVector<int> &blocks )
+{
+	qint64 size = (qint64) numDataPoints * sizeof( float );
+	for ( int numBlocks : blocks )
+		size += (qint64) numBlocks * ( 2 * sizeof( float ) + 2 * sizeof( qint32 ) );
+	return size;
+}
+
+template< typename T >
+void readArray( const uchar *&p, QVector<T> &vector, int count )
+{
+	vector.resize( count );
+	memcpy( vector.data(), p, count * sizeof( T ) );
+	p += count * sizeof( T );
+}
+
+// the samples of a column go through SignalMemory like those of a parsed file
+void readColumn( const uchar *&p, QVector<float> &column, int count )
+{
+	SignalMemory::allocate( column, count );
+	memcpy( column.data(), p, count * sizeof( float ) );
+	p += count * sizeof( float );
+}
+
+template< typename T >
+bool writeArray( QSaveFile &file, const QVector<T> &vector )
+{
+	qint64 size = (qint64) vector.size() * sizeof( T );
+	return file.write( (const char *) vector.constData(), size ) == size;
+}
+
+}  // end anonymous namespace
+
+
+QString SignalCache::cacheFilename( const QString &filename )
+{
+	return filename + ".sigcache";
+}
+
+bool SignalCache::load( const QString &filename,
+						char delimiter,
+						bool bHeaderRow,
+						int expectedDataPoints,
+						QVector< QVector<float> > &columns,
+						QVector< SignalSummary > &summaries,
+						QString &sError )
+{
+	sError.clear();
+	QFile file( cacheFilename( filename ) );
+	if ( !file.open( QIODevice::ReadOnly ) ||
+		 file.size() < (qint64) sizeof( CacheHeader ) )
+		return false;
+
+	const uchar *pCache = file.map( 0, file.size() );
+	if ( !pCache )
+		return false;
+
+	// the cache has to have been written for this very file, parsed the same way
+	CacheHeader header;
+	memcpy( &header, pCache, sizeof( header ) );
+	CacheHeader source;
+	if ( memcmp( header.magic, s_magic, sizeof( s_magic ) ) ||
+		 header.version != s_version ||
+		 header.delimiter != delimiter ||
+		 header.bHeaderRow != ( bHeaderRow ? 1 : 0 ) ||
+		 header.numColumns < 1 ||
+		 header.numDataPoints < 1 ||
+		 !setSourceKey( filename, source ) ||
+		 header.sourceSize != source.sourceSize ||
+		 header.sourceModified != source.sourceModified ||
+		 header.sourceHash != source.sourceHash )
+		return false;
+
+	QVector<int> blocks = levelBlocks( header.numDataPoints );
+	if ( header.numLevels != blocks.count() ||
+		 file.size() != (qint64) sizeof( CacheHeader ) +
+						(qint64) header.numColumns * ( (qint64) sizeof( ColumnHeader ) +
+													   columnSize( header.numDataPoints, blocks ) ) )
+		return false;
+
+	// the file is rejected, as it would be by the reader, before its columns are allocated
+	if ( expectedDataPoints && header.numDataPoints != expectedDataPoints )
+	{
+		sError = "Number of data points is not the same as that of previously loaded files";
+		return false;
+	}
+
+	// as for the reader, what the store will take for the columns is reserved, so that a file
+	// the store would reject for its size is not loaded first
+	qint64 reserved = SignalMemory::signalBytes( header.numDataPoints ) * header.numColumns;
+	if ( !SignalMemory::reserve( reserved ) )
+	{
+		sError = QString( "Not enough memory within the budget of %1 MB for %2 data points" )
+				 .arg( SignalMemory::budget() >> 20 ).arg( header.numDataPoints );
+		return false;
+	}
+
+	columns.resize( header.numColumns );
+	summaries.resize( header.numColumns );
+	const uchar *p = pCache + sizeof( CacheHeader ) + header.numColumns * sizeof( ColumnHeader );
+	for ( int ii=0; ii<(int) header.numColumns; ii++ )
+	{
+		ColumnHeader column;
+		memcpy( &column, pCache + sizeof( CacheHeader ) + ii * sizeof( ColumnHeader ), sizeof( column ) );
+
+		SignalSummary &summary = summaries[ ii ];
+		summary.m_smallestY = column.smallestY;
+		summary.m_largestY = column.largestY;
+		summary.m_scale = column.scale;
+		summary.m_minima.resize( blocks.count() );
+		summary.m_maxima.resize( blocks.count() );
+		summary.m_minIndex.resize( blocks.count() );
+		summary.m_maxIndex.resize( blocks.count() );
+
+		readColumn( p, columns[ ii ], header.numDataPoints );
+		for ( int level=0; level<blocks.count(); level++ )
+		{
+			readArray( p, summary.m_minima[ level ], blocks.at( level ) );
+			readArray( p, summary.m_maxima[ level ], blocks.at( level ) );
+			readArray( p, summary.m_minIndex[ level ], blocks.at( level ) );
+			readArray( p, summary.m_maxIndex[ level ], blocks.at( level ) );
+		}
+	}
+
+	file.unmap( (uchar *) pCache );
+
+	// the reservation only covers the loading, the store the columns go to reserves their
+	// memory for as long as it holds them
+	SignalMemory::release( reserved );
+	return true;
+}  // end load
+
+bool SignalCache::save( const QString &filename,
+						char delimiter,
+						bool bHeaderRow,
+						const QVector< QVector<float> > &columns,
+						const QVector< SignalSummary > &summaries )
+{
+	Q_ASSERT( columns.count() == summaries.count() );
+	if ( columns.isEmpty() )
+		return false;
+
+	CacheHeader header;
+	memset( &header, 0, sizeof( header ) );
+	memcpy( header.magic, s_magic, sizeof( s_magic ) );
+	header.version = s_version;
+	header.numColumns = columns.count();
+	header.delimiter = delimiter;
+	header.bHeaderRow = bHeaderRow ? 1 : 0;
+	header.numDataPoints = columns.first().size();
+	header.numLevels = summaries.first().levels();
+	if ( !setSourceKey( filename, header ) )
+		return false;
+
+	// QSaveFile only replaces the previous cache once the new one is complete
+	QSaveFile file( cacheFilename( filename ) );
+	if ( !file.open( QIODevice::WriteOnly ) )
+		return false;
+
+	bool bOk = file.write( (const char *) &header, sizeof( header ) ) == sizeof( header );
+	for ( int ii=0; bOk && ii<columns.count(); ii++ )
+	{
+		ColumnHeader column;
+		column.smallestY = summaries.at( ii ).smallestY();
+		column.largestY = summaries.at( ii ).largestY();
+		column.scale = summaries.at( ii ).scale();
+		column.reserved = 0;
+		bOk = file.write( (const char *) &column, sizeof( column ) ) == sizeof( column );
+	}
+
+	for ( int ii=0; bOk && ii<columns.count(); ii++ )
+	{
+		const SignalSummary &summary = summaries.at( ii );
+		bOk = writeArray( file, columns.at( ii ) );
+		for ( int level=0; bOk && level<summary.levels(); level++ )
+		{
+			bOk = writeArray( file, summary.m_minima.at( level ) ) &&
+				  writeArray( file, summary.m_maxima.at( level ) ) &&
+				  writeArray( file, summary.m_minIndex.at( level ) ) &&
+				  writeArray( file, summary.m_maxIndex.at( level ) );
+		}
+	}
+
+	if ( !bOk )
+	{
+		file.cancelWriting();
+		return false;
+	}
+
+	return file.commit();
+}  // end save
@@ -0,0 +1,46 @@
+#ifndef SIGNALCACHE_H
+#define SIGNALCACHE_H
+
+#include <QVector>
+#include <QString>
+
+#include "signalsummary.h"
+
+
+// binary sidecar cache of a parsed signal file, written next to it as <file>.sigcache
+// the cache holds the samples of every column of the file along w/ their summaries, and is
+// keyed by the size, modification time and a sampled hash of the file, as well as by the
+// delimiter and header settings it was parsed with
+// a cache that does not match its file is stale and is simply rebuilt by the next save()
+// loading maps the cache but copies its samples and pyramid into vectors, since the signals
+// own their data, so it costs a read and a copy of the cache instead of a parse of the file
+// the statistics and event indexes of the store are not cached, they are rebuilt in O(n) per
+// signal when the columns are added to the store
+class SignalCache
+{
+public:
+	static QString cacheFilename( const QString &filename );
+
+	// loads the columns of the given file and their summaries from its cache
+	// returns false if there is no cache or it is stale, in which case the file has to be parsed,
+	// or sets sError as well if the cache is up to date but the file is rejected, since it does
+	// not have expectedDataPoints data points (0 being any number) or its columns do not fit in
+	// the memory budget
+	static bool load( const QString &filename,
+					  char delimiter,
+					  bool bHeaderRow,
+					  int expectedDataPoints,
+					  QVector< QVector<float> > &columns,
+					  QVector< SignalSummary > &summaries,
+					  QString &sError );
+
+	// writes the cache of the given file, replacing any previous one atomically
+	// returns false if the cache could not be written, which is not an error for the caller
+	static bool save( const QString &filename,
+					  char delimiter,
+					  bool bHeaderRow,
+					  const QVector< QVector<float> > &columns,
+					  const QVector< SignalSummary > &summaries );
+};
+
+#endif // SIGNALCACHE_H
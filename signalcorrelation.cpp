@@ -0,0 +1,345 @@
+#include "signalcorrelation.h"
+#include "signalmemory.h"
+
+#include <QThread>
+#include <QtConcurrent>
+
+#include <complex>
+#include <cmath>
+
+
+namespace
+{
+
+typedef std::complex<float> Complex;
+
+// the smallest number of butterflies or data points worth handing to a separate thread
+const int s_minTaskSize = 1 << 14;
+
+// calls work( first, last ) on ranges that split [0, count) among the threads
+template< typename Work >
+void parallelFor( int count, Work work )
+{
+	int numTasks = qBound( 1, count / s_minTaskSize, QThread::idealThreadCount() * 4 );
+	QVector<int> tasks( numTasks );
+	for ( int ii=0; ii<numTasks; ii++ )
+		tasks[ ii ] = ii;
+
+	QtConcurrent::blockingMap( tasks, [&]( int task )
+	{
+		work( (int) ( (qint64) count * task / numTasks ),
+			  (int) ( (qint64) count * ( task + 1 ) / numTasks ) );
+	} );
+}
+
+// written out rather than w/ std::complex so that it does not check for NaN and infinities
+inline Complex multiply( const Complex &a, const Complex &b )
+{
+	return Complex( a.real() * b.real() - a.imag() * b.imag(),
+					a.real() * b.imag() + a.imag() * b.real() );
+}
+
+// number of data points whose butterflies are done together while they are in the cache
+const int s_fftBlockSize = 1 << 14;
+
+// one stage of butterflies over the whole of data, the butterflies of a stage being independent
+// of each other
+// a decimation in frequency stage does top + bottom and ( top - bottom ) * twiddle, a
+// decimation in time stage top + bottom * twiddle and top - bottom * twiddle
+void fftStage( Complex *pData, const Complex *pTwiddles, int size, int halfBits, bool bInverse )
+{
+	int half = 1 << halfBits,
+			twiddleShift = 0;
+	while ( ( half << ( twiddleShift + 1 ) ) < size )
+		twiddleShift++;
+
+	parallelFor( size / 2, [&]( int first, int last )
+	{
+		for ( int butterfly=first; butterfly<last; butterfly++ )
+		{
+			int k = butterfly & ( half - 1 ),
+					top = ( ( butterfly >> halfBits ) << ( halfBits + 1 ) ) + k,
+					bottom = top + half;
+			Complex twiddle = pTwiddles[ k << twiddleShift ];
+			if ( bInverse )
+			{
+				Complex product = multiply( std::conj( twiddle ), pData[ bottom ] );
+				pData[ bottom ] = pData[ top ] - product;
+				pData[ top ] += product;
+			}
+			else
+			{
+				Complex difference = pData[ top ] - pData[ bottom ];
+				pData[ top ] += pData[ bottom ];
+				pData[ bottom ] = multiply( twiddle, difference );
+			}
+		}
+	} );
+}  // end fftStage
+
+// two stages of butterflies over the whole of data in a single pass, the stage whose butterflies
+// are 2^halfBits wide and the one below it, each group of four data points being read and
+// written once for both
+void fftStagePair( Complex *pData, const Complex *pTwiddles, int size, int halfBits, bool bInverse )
+{
+	int quarter = 1 << ( halfBits - 1 ),
+			twiddleShift = 0;
+	while ( ( quarter << ( twiddleShift + 2 ) ) < size )
+		twiddleShift++;
+
+	parallelFor( size / 4, [&]( int first, int last )
+	{
+		for ( int group=first; group<last; group++ )
+		{
+			int k = group & ( quarter - 1 ),
+					top = ( ( group >> ( halfBits - 1 ) ) << ( halfBits + 1 ) ) + k;
+			Complex *p0 = pData + top,
+					*p1 = p0 + quarter,
+					*p2 = p1 + quarter,
+					*p3 = p2 + quarter;
+			Complex wide = pTwiddles[ k << twiddleShift ],
+					wideQuarter = pTwiddles[ ( k + quarter ) << twiddleShift ],
+					narrow = pTwiddles[ k << ( twiddleShift + 1 ) ];
+			if ( bInverse )
+			{
+				// the narrow stage, then the wide one
+				Complex product = multiply( std::conj( narrow ), *p1 ),
+						b0 = *p0 + product,
+						b1 = *p0 - product;
+				product = multiply( std::conj( narrow ), *p3 );
+				Complex b2 = *p2 + product,
+						b3 = *p2 - product;
+				product = multiply( std::conj( wide ), b2 );
+				*p0 = b0 + product;
+				*p2 = b0 - product;
+				product = multiply( std::conj( wideQuarter ), b3 );
+				*p1 = b1 + product;
+				*p3 = b1 - product;
+			}
+			else
+			{
+				// the wide stage, then the narrow one
+				Complex b0 = *p0 + *p2,
+						b2 = multiply( wide, *p0 - *p2 ),
+						b1 = *p1 + *p3,
+						b3 = multiply( wideQuarter, *p1 - *p3 );
+				*p0 = b0 + b1;
+				*p1 = multiply( narrow, b0 - b1 );
+				*p2 = b2 + b3;
+				*p3 = multiply( narrow, b2 - b3 );
+			}
+		}
+	} );
+}  // end fftStagePair
+
+// the stages whose butterflies stay within blocks of s_fftBlockSize data points, done block by
+// block so that each block is read from memory once for all of them
+void fftBlockStages( Complex *pData, const Complex *pTwiddles, int size, bool bInverse )
+{
+	int blockSize = qMin( size, s_fftBlockSize );
+	parallelFor( size / blockSize, [&]( int first, int last )
+	{
+		for ( int block=first; block<last; block++ )
+		{
+			Complex *pBlock = pData + block * blockSize;
+			for ( int stage=0; ( 2 << stage ) <= blockSize; stage++ )
+			{
+				// forward goes from the largest butterflies down, the inverse back up
+				int half = bInverse ? 1 << stage : blockSize >> ( stage + 1 ),
+						twiddleStep = size / ( 2 * half );
+				for ( int top=0; top<blockSize; top+=2*half )
+				{
+					for ( int k=0; k<half; k++ )
+					{
+						Complex &a = pBlock[ top + k ],
+								&b = pBlock[ top + k + half ];
+						Complex twiddle = pTwiddles[ k * twiddleStep ];
+						if ( bInverse )
+						{
+							Complex product = multiply( std::conj( twiddle ), b );
+							b = a - product;
+							a += product;
+						}
+						else
+						{
+							Complex difference = a - b;
+							a += b;
+							b = multiply( twiddle, difference );
+						}
+					}
+				}
+			}  // end for each stage
+		}
+	} );
+}  // end fftBlockStages
+
+// in place radix-2 FFT of data, whose size is a power of 2, w/ twiddles[ k ] being
+// exp( -2 pi i k / size ) for k in [0, size / 2)
+// the forward FFT leaves the spectrum in bit reversed order, which the inverse FFT takes back
+// to natural order, so that the data is never permuted, the inverse being left unscaled
+void fft( QVector<Complex> &data, const QVector<Complex> &twiddles, bool bInverse )
+{
+	int size = data.size(),
+			bits = 0;
+	while ( ( 1 << bits ) < size )
+		bits++;
+
+	// the stages w/ butterflies wider than a block go over the whole of data, two at a time
+	int blockBits = 0;
+	while ( ( 1 << blockBits ) < qMin( size, s_fftBlockSize ) )
+		blockBits++;
+
+	Complex *pData = data.data();
+	const Complex *pTwiddles = twiddles.constData();
+	if ( bInverse )
+	{
+		fftBlockStages( pData, pTwiddles, size, true );
+		int halfBits = blockBits;
+		for ( ; halfBits+1<bits; halfBits+=2 )
+			fftStagePair( pData, pTwiddles, size, halfBits + 1, true );
+		if ( halfBits < bits )
+			fftStage( pData, pTwiddles, size, halfBits, true );
+	}
+	else
+	{
+		int halfBits = bits - 1;
+		for ( ; halfBits-1>=blockBits; halfBits-=2 )
+			fftStagePair( pData, pTwiddles, size, halfBits, false );
+		if ( halfBits >= blockBits )
+			fftStage( pData, pTwiddles, size, halfBits, false );
+		fftBlockStages( pData, pTwiddles, size, false );
+	}
+}  // end fft
+
+// returns the mean of the data points that are not missing, and their energy about it
+void moments( const QVector<float> &data, double &mean, double &energy )
+{
+	double sum = 0.0,
+			squares = 0.0;
+	int count = 0;
+	for ( float value : data )
+	{
+		if ( value != value )
+			continue;
+		sum += value;
+		squares += (double) value * value;
+		count++;
+	}
+
+	mean = count ? sum / count : 0.0;
+	energy = qMax( squares - mean * sum, 0.0 );
+}
+
+}  // end anonymous namespace
+
+
+SignalLag SignalCorrelation::bestLag( const QVector<float> &first, const QVector<float> &second, int maxLag )
+{
+	SignalLag result = { 0, 0, 0, 0.0f, false };
+	int count = qMax( first.size(), second.size() );
+	if ( first.isEmpty() || second.isEmpty() )
+		return result;
+	if ( maxLag < 0 || maxLag > count - 1 )
+		maxLag = count - 1;
+
+	// the FFTs are circular, so they need room for the lags searched on either side to keep the
+	// correlations at those lags from wrapping into each other
+	int size = 1;
+	while ( size < count + maxLag )
+		size *= 2;
+
+	double firstMean = 0.0,
+			firstEnergy = 0.0,
+			secondMean = 0.0,
+			secondEnergy = 0.0;
+	moments( first, firstMean, firstEnergy );
+	moments( second, secondMean, secondEnergy );
+	if ( firstEnergy <= 0.0 || secondEnergy <= 0.0 )
+		return result;
+
+	// the FFT data and its twiddles are held against the memory budget while they are used
+	qint64 reserved = ( (qint64) size + size / 2 ) * (qint64) sizeof( Complex );
+	if ( !SignalMemory::reserve( reserved ) )
+		return result;
+
+	QVector<Complex> twiddles( size / 2 );
+	Complex *pTwiddles = twiddles.data();
+	parallelFor( size / 2, [&]( int firstIndex, int lastIndex )
+	{
+		for ( int ii=firstIndex; ii<lastIndex; ii++ )
+		{
+			double angle = -2.0 * M_PI * ii / size;
+			pTwiddles[ ii ] = Complex( (float) cos( angle ), (float) sin( angle ) );
+		}
+	} );
+
+	// the first signal goes in the real parts and the second in the imaginary parts, both
+	// relative to their mean
+	QVector<Complex> data( size );
+	Complex *pData = data.data();
+	const float *pFirst = first.constData(),
+			*pSecond = second.constData();
+	int firstCount = first.size(),
+			secondCount = second.size();
+	parallelFor( count, [&]( int firstIndex, int lastIndex )
+	{
+		for ( int ii=firstIndex; ii<lastIndex; ii++ )
+		{
+			float real = ii < firstCount && pFirst[ ii ] == pFirst[ ii ] ? pFirst[ ii ] - (float) firstMean : 0.0f,
+					imaginary = ii < secondCount && pSecond[ ii ] == pSecond[ ii ] ? pSecond[ ii ] - (float) secondMean : 0.0f;
+			pData[ ii ] = Complex( real, imaginary );
+		}
+	} );
+
+	fft( data, twiddles, false );
+
+	// split the spectrum into those of the two signals and multiply the first by the conjugate
+	// of the second, the spectra of real signals being conjugate symmetric the frequencies k and
+	// size - k are done together
+	// in bit reversed order, frequency size - k of the one at position p, 2^m <= p < 2^(m + 1),
+	// is at position 3 * 2^m - 1 - p, and positions 0 and 1 are their own mirrors
+	parallelFor( size, [&]( int first, int last )
+	{
+		int octave = 1;
+		for ( int p=first; p<last; p++ )
+		{
+			while ( p >= 2 * octave )
+				octave *= 2;
+			int mirror = p < 2 ? p : 3 * octave - 1 - p;
+			if ( mirror < p )
+				continue;
+
+			Complex z = pData[ p ],
+					zMirror = std::conj( pData[ mirror ] );
+			Complex firstSpectrum = ( z + zMirror ) * 0.5f,
+					secondSpectrum = multiply( z - zMirror, Complex( 0.0f, -0.5f ) );
+			Complex product = multiply( firstSpectrum, std::conj( secondSpectrum ) );
+			pData[ p ] = product;
+			pData[ mirror ] = std::conj( product );
+		}
+	} );
+
+	fft( data, twiddles, true );
+
+	// lag l is at index l, and negative lags wrap around to the end
+	int bestLag = 0;
+	float bestCorrelation = 0.0f;
+	for ( int lag=-maxLag; lag<=maxLag; lag++ )
+	{
+		float correlation = pData[ lag & ( size - 1 ) ].real();
+		if ( fabsf( correlation ) > fabsf( bestCorrelation ) )
+		{
+			bestCorrelation = correlation;
+			bestLag = lag;
+		}
+	}
+
+	data = QVector<Complex>();
+	twiddles = QVector<Complex>();
+	SignalMemory::release( reserved );
+
+	result.lag = bestLag;
+	result.coefficient = (float) ( bestCorrelation / size / sqrt( firstEnergy * secondEnergy ) );
+	result.bValid = true;
+	return result;
+}  // end bestLag
@@ -0,0 +1,34 @@
+#ifndef SIGNALCORRELATION_H
+#define SIGNALCORRELATION_H
+
+#include <QVector>
+
+
+// lag at which two signals line up best
+struct SignalLag
+{
+	int first;
+	int second;
+	int lag;            // the first signal lags the second by this many data points
+	float coefficient;  // normalized correlation at that lag, negative if the signals are inverted
+	bool bValid;
+};
+
+
+// cross-correlation of two signals through FFTs, in O(n log n) instead of O(n^2)
+// both signals are packed into a single complex FFT, the product of their spectra is brought
+// back w/ an inverse FFT, and every stage of the FFTs is split among the threads
+// missing (NaN) data points count as the mean of their signal so they add nothing
+class SignalCorrelation
+{
+public:
+	// returns the lag in [-maxLag, maxLag] at which the first signal best matches the second,
+	// that is the lag that maximizes the magnitude of sum( first[ t + lag ] * second[ t ] )
+	// a negative maxLag searches every lag
+	// the result is not valid if either signal is empty or constant, or if the FFT and its
+	// twiddles do not fit in the memory budget, which takes 12 bytes per data point of the FFT,
+	// whose size is up to twice the length of the signals rounded up to a power of 2
+	static SignalLag bestLag( const QVector<float> &first, const QVector<float> &second, int maxLag = -1 );
+};
+
+#endif // SIGNALCORRELATION_H
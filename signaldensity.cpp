@@ -0,0 +1,205 @@
+#include "signaldensity.h"
+
+#include <QThread>
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+
+DensityGrid::DensityGrid()
+	: columnWidth( 0.0f ),
+	  rowHeight( 0.0f ),
+	  firstColumn( 0 ),
+	  firstRow( 0 ),
+	  columns( 0 ),
+	  rows( 0 )
+{
+
+}
+
+bool DensityGrid::operator==( const DensityGrid &other ) const
+{
+	return columnWidth == other.columnWidth &&
+			rowHeight == other.rowHeight &&
+			firstColumn == other.firstColumn &&
+			firstRow == other.firstRow &&
+			columns == other.columns &&
+			rows == other.rows;
+}
+
+
+SignalDensity::SignalDensity()
+	: m_xStep( 0.0f ),
+	  m_scale( 0.0f ),
+	  m_offset( 0 ),
+	  m_numDataPoints( 0 )
+{
+
+}
+
+void SignalDensity::clear()
+{
+	m_hits.clear();
+	m_numDataPoints = 0;
+}
+
+void SignalDensity::accumulate( const QVector<float> &data, float xStep, float scale, int offset,
+								const DensityGrid &grid )
+{
+	int count = data.size();
+	const float *pData = data.constData();
+
+	// the hits are kept if only the 1st column of the grid and the number of data points changed
+	bool bKeepHits = !m_hits.isEmpty() &&
+			grid.columnWidth == m_grid.columnWidth &&
+			grid.rowHeight == m_grid.rowHeight &&
+			grid.firstRow == m_grid.firstRow &&
+			grid.columns == m_grid.columns &&
+			grid.rows == m_grid.rows &&
+			xStep == m_xStep &&
+			scale == m_scale &&
+			offset == m_offset &&
+			count >= m_numDataPoints;
+
+	if ( !bKeepHits )
+	{
+		m_grid = grid;
+		m_xStep = xStep;
+		m_scale = scale;
+		m_offset = offset;
+		m_hits.fill( 0, grid.columns * grid.rows );
+		accumulate( pData, 0, count - 1, 0, grid.columns );
+		m_numDataPoints = count;
+		return;
+	}
+
+	// shift the hits of the columns still in view, a positive shift moves them to the left
+	int columns = grid.columns,
+			shift = grid.firstColumn - m_grid.firstColumn;
+	int firstExposed = 0,
+			lastExposed = 0;
+	if ( qAbs( shift ) >= columns )
+	{
+		m_hits.fill( 0 );
+		lastExposed = columns;
+	}
+	else if ( shift )
+	{
+		int kept = columns - qAbs( shift );
+		quint32 *pHits = m_hits.data();
+		for ( int row=0; row<grid.rows; row++ )
+		{
+			quint32 *pRow = pHits + row * columns;
+			if ( shift > 0 )
+			{
+				memmove( pRow, pRow + shift, kept * sizeof( quint32 ) );
+				memset( pRow + kept, 0, shift * sizeof( quint32 ) );
+			}
+			else
+			{
+				memmove( pRow - shift, pRow, kept * sizeof( quint32 ) );
+				memset( pRow, 0, -shift * sizeof( quint32 ) );
+			}
+		}
+
+		firstExposed = shift > 0 ? kept : 0;
+		lastExposed = shift > 0 ? columns : -shift;
+	}
+	m_grid = grid;
+
+	// the columns that came into view get every segment, the others only the new ones
+	accumulate( pData, 0, count - 1, firstExposed, lastExposed );
+	int firstNew = qMax( m_numDataPoints - 1, 0 );
+	accumulate( pData, firstNew, count - 1, 0, firstExposed );
+	accumulate( pData, firstNew, count - 1, lastExposed, columns );
+	m_numDataPoints = count;
+}  // end accumulate
+
+void SignalDensity::accumulate( const float *pData, int firstSegment, int lastSegment,
+								int firstColumn, int lastColumn )
+{
+	if ( firstSegment >= lastSegment || firstColumn >= lastColumn )
+		return;
+
+	// every tile owns its columns so the threads never count on the same pixel
+	int numColumns = lastColumn - firstColumn;
+	int numTasks = qMin( ( numColumns + 15 ) / 16, QThread::idealThreadCount() * 4 );
+	QVector<int> tasks( numTasks );
+	for ( int ii=0; ii<numTasks; ii++ )
+		tasks[ ii ] = ii;
+
+	// positions are taken in columns and rows of the grid
+	double segmentWidth = (double) m_xStep / m_grid.columnWidth,
+			rowsPerUnit = (double) m_scale / m_grid.rowHeight;
+	int columns = m_grid.columns,
+			rows = m_grid.rows;
+	quint32 *pHits = m_hits.data();
+	QtConcurrent::blockingMap( tasks, [&]( int task )
+	{
+		int tileFirst = firstColumn + numColumns * task / numTasks,
+				tileLast = firstColumn + numColumns * ( task + 1 ) / numTasks;
+
+		// segment ii goes from column ( ii - origin ) * segmentWidth to the next data point
+		double origin = m_grid.firstColumn / segmentWidth - m_offset;
+		int first = (int) qBound( (double) firstSegment, floor( origin + tileFirst / segmentWidth ) - 1.0,
+								  (double) lastSegment ),
+				last = (int) qBound( (double) firstSegment, ceil( origin + tileLast / segmentWidth ) + 1.0,
+									 (double) lastSegment );
+		for ( int segment=first; segment<last; segment++ )
+		{
+			float y0 = pData[ segment ],
+					y1 = pData[ segment + 1 ];
+			if ( y0 != y0 || y1 != y1 )
+				continue;
+
+			double x0 = ( segment - origin ) * segmentWidth,
+					x1 = x0 + segmentWidth,
+					r0 = y0 * rowsPerUnit - m_grid.firstRow,
+					r1 = y1 * rowsPerUnit - m_grid.firstRow;
+			int firstHit = qMax( (int) qMax( floor( x0 ), -1.0 ), tileFirst ),
+					lastHit = qMin( (int) qMin( floor( x1 ), (double) columns ), tileLast - 1 );
+			for ( int column=firstHit; column<=lastHit; column++ )
+			{
+				// the part of the segment over this column
+				double ra = r0 + ( r1 - r0 ) * ( qMax( x0, (double) column ) - x0 ) / segmentWidth,
+						rb = r0 + ( r1 - r0 ) * ( qMin( x1, column + 1.0 ) - x0 ) / segmentWidth;
+				int lowRow = (int) qMax( floor( qMin( ra, rb ) ), 0.0 ),
+						highRow = (int) qMin( floor( qMax( ra, rb ) ), rows - 1.0 );
+				for ( int row=lowRow; row<=highRow; row++ )
+					pHits[ row * columns + column ]++;
+			}
+		}  // end for each segment
+	} );
+}  // end accumulate
+
+void SignalDensity::paint( const float *pColor, uchar *pRgba ) const
+{
+	if ( m_hits.isEmpty() )
+		return;
+
+	quint32 maxHits = *std::max_element( m_hits.constBegin(), m_hits.constEnd() );
+	if ( !maxHits )
+		return;
+
+	// the ramp is logarithmic so that rare excursions stay visible next to the dense band
+	float logMaxHits = log1pf( maxHits );
+	const quint32 *pHits = m_hits.constData();
+	for ( int ii=0; ii<m_hits.size(); ii++ )
+	{
+		if ( !pHits[ ii ] )
+			continue;
+
+		float intensity = 2.0f * log1pf( pHits[ ii ] ) / logMaxHits;
+		float toColor = qMin( intensity, 1.0f ),
+				toWhite = qMax( intensity - 1.0f, 0.0f );
+		uchar *pPixel = pRgba + 4 * ii;
+		for ( int jj=0; jj<3; jj++ )
+		{
+			int value = pPixel[ jj ] + (int) ( 255.0f * ( pColor[ jj ] * toColor + ( 1.0f - pColor[ jj ] ) * toWhite ) + 0.5f );
+			pPixel[ jj ] = (uchar) qMin( value, 255 );
+		}
+		pPixel[ 3 ] = 255;
+	}
+}  // end paint
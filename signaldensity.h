@@ -0,0 +1,69 @@
+#ifndef SIGNALDENSITY_H
+#define SIGNALDENSITY_H
+
+#include <QVector>
+
+
+// lattice of pixels the hits of a signal are counted on, in model coordinates
+// column ii covers X in [ ( firstColumn + ii ) * columnWidth, ( firstColumn + ii + 1 ) * columnWidth ),
+// and row ii covers Y likewise, row 0 being at the bottom
+// keeping the lattice anchored at the origin means panning only changes firstColumn and firstRow
+struct DensityGrid
+{
+	DensityGrid();
+
+	bool operator==( const DensityGrid &other ) const;
+	bool operator!=( const DensityGrid &other ) const { return !( *this == other ); }
+
+	float columnWidth;
+	float rowHeight;
+	int firstColumn;
+	int firstRow;
+	int columns;
+	int rows;
+};
+
+
+// per pixel hit counts of the line segments of a signal, the way the phosphor of an analog
+// oscilloscope accumulates the traces that go over it, so that heavily overlapping data points
+// show how often the signal goes through each value instead of a solid band
+// the counts are accumulated in parallel tiles of columns, and kept from one call to the next
+// so that appending data points or panning horizontally only counts the new segments or columns
+class SignalDensity
+{
+public:
+	SignalDensity();
+
+	// counts the hits of the line segments of data scaled by scale and shifted right by offset
+	// data points on the given grid
+	// data must be the data of the previous call, or the data of the previous call followed by
+	// more data points, otherwise call clear() first
+	void accumulate( const QVector<float> &data, float xStep, float scale, int offset,
+					 const DensityGrid &grid );
+
+	// forgets the hits, the next call to accumulate() counts them all again
+	void clear();
+
+	const DensityGrid &grid() const { return m_grid; }
+
+	// adds the hits to the given RGBA image of the size of the grid, row 0 at the bottom, through
+	// a ramp that goes from black to the given color at half the largest count, then to white
+	void paint( const float *pColor, uchar *pRgba ) const;
+
+private:
+	// counts the hits of the segments in [firstSegment, lastSegment) on the columns in
+	// [firstColumn, lastColumn), segment ii being the one from data point ii to data point ii + 1
+	void accumulate( const float *pData, int firstSegment, int lastSegment,
+					 int firstColumn, int lastColumn );
+
+	DensityGrid m_grid;
+	float m_xStep;
+	float m_scale;
+	int m_offset;
+	int m_numDataPoints;
+
+	// row major, m_grid.columns hits per row
+	QVector<quint32> m_hits;
+};
+
+#endif // SIGNALDENSITY_H
@@ -0,0 +1,200 @@
+#include "signalevents.h"
+
+#include <QThread>
+#include <QtConcurrent>
+
+#include <algorithm>
+
+
+namespace
+{
+
+// the scans test blocks of this many data points w/o branching, which the compiler vectorizes,
+// and only look for the events themselves in the blocks that have any
+const int s_scanBlock = 64;
+
+// splits [begin, end) in chunks that are scanned in parallel by scanChunk( first, last, events ),
+// which appends the events it finds in [first, last) to events[ 0 .. numKinds-1 ]
+// the events of every chunk are then gathered, in order, into pEvents[ 0 .. numKinds-1 ]
+template< typename ScanChunk >
+void parallelScan( int begin, int end, int numKinds, ScanChunk scanChunk, QVector<qint32> *pEvents )
+{
+	for ( int kind=0; kind<numKinds; kind++ )
+		pEvents[ kind ].clear();
+	if ( end <= begin )
+		return;
+
+	int numChunks = qMax( 1, qMin( ( end - begin ) / 65536, QThread::idealThreadCount() * 4 ) );
+	QVector< QVector< QVector<qint32> > > chunkEvents( numChunks );
+	QVector<int> tasks( numChunks );
+	for ( int ii=0; ii<numChunks; ii++ )
+	{
+		chunkEvents[ ii ].resize( numKinds );
+		tasks[ ii ] = ii;
+	}
+
+	QVector< QVector<qint32> > *pChunkEvents = chunkEvents.data();
+	QtConcurrent::blockingMap( tasks, [&]( int task )
+	{
+		int first = begin + (int) ( (qint64) ( end - begin ) * task / numChunks ),
+				last = begin + (int) ( (qint64) ( end - begin ) * ( task + 1 ) / numChunks );
+		scanChunk( first, last, pChunkEvents[ task ].data() );
+	} );
+
+	for ( int kind=0; kind<numKinds; kind++ )
+	{
+		int count = 0;
+		for ( const QVector< QVector<qint32> > &events : chunkEvents )
+			count += events.at( kind ).size();
+		pEvents[ kind ].reserve( count );
+		for ( const QVector< QVector<qint32> > &events : chunkEvents )
+			pEvents[ kind ] += events.at( kind );
+	}
+}  // end parallelScan
+
+}  // end anonymous namespace
+
+
+SignalEvents::SignalEvents()
+	: m_threshold( 0.0f )
+{
+
+}
+
+void SignalEvents::build( const QVector<float> &data, float threshold )
+{
+	const float *pData = data.constData();
+	int count = data.size();
+
+	// local extrema, data points above or below both neighbours, where the neighbour after a
+	// plateau is the 1st data point past it and the plateau is indexed by its 1st data point
+	parallelScan( 1, count - 1, 1, [=]( int first, int last, QVector<qint32> *pEvents )
+	{
+		for ( int ii=first; ii<last; ii++ )
+		{
+			float value = pData[ ii ],
+					previous = pData[ ii - 1 ];
+			if ( value == previous )
+				continue;
+
+			int next = ii + 1;
+			while ( next < count - 1 && pData[ next ] == value )
+				next++;
+			if ( ( value > previous && value > pData[ next ] ) ||
+				 ( value < previous && value < pData[ next ] ) )
+				pEvents[ 0 ].push_back( ii );
+		}
+	}, &m_extrema );
+
+	// gaps, the 1st data point of each run of NaN
+	parallelScan( 0, count, 1, [=]( int first, int last, QVector<qint32> *pEvents )
+	{
+		for ( int block=first; block<last; block+=s_scanBlock )
+		{
+			int blockEnd = qMin( block + s_scanBlock, last );
+			int any = 0;
+			for ( int ii=block; ii<blockEnd; ii++ )
+				any |= pData[ ii ] != pData[ ii ];
+			if ( !any )
+				continue;
+
+			for ( int ii=block; ii<blockEnd; ii++ )
+			{
+				if ( pData[ ii ] != pData[ ii ] &&
+					 ( ii == 0 || pData[ ii - 1 ] == pData[ ii - 1 ] ) )
+					pEvents[ 0 ].push_back( ii );
+			}
+		}
+	}, &m_gaps );
+
+	setThreshold( data, threshold );
+}  // end build
+
+void SignalEvents::setThreshold( const QVector<float> &data, float threshold )
+{
+	m_threshold = threshold;
+
+	// NaN is neither below nor above the threshold, so gaps never count as crossings
+	const float *pData = data.constData();
+	QVector<qint32> crossings[ 2 ];
+	parallelScan( 1, data.size(), 2, [=]( int first, int last, QVector<qint32> *pEvents )
+	{
+		for ( int block=first; block<last; block+=s_scanBlock )
+		{
+			int blockEnd = qMin( block + s_scanBlock, last );
+			int any = 0;
+			for ( int ii=block; ii<blockEnd; ii++ )
+			{
+				any |= ( ( pData[ ii - 1 ] < threshold ) & ( pData[ ii ] >= threshold ) ) |
+					   ( ( pData[ ii - 1 ] >= threshold ) & ( pData[ ii ] < threshold ) );
+			}
+			if ( !any )
+				continue;
+
+			for ( int ii=block; ii<blockEnd; ii++ )
+			{
+				if ( pData[ ii - 1 ] < threshold && pData[ ii ] >= threshold )
+					pEvents[ 0 ].push_back( ii );
+				else if ( pData[ ii - 1 ] >= threshold && pData[ ii ] < threshold )
+					pEvents[ 1 ].push_back( ii );
+			}
+		}
+	}, crossings );
+
+	m_rising.swap( crossings[ 0 ] );
+	m_falling.swap( crossings[ 1 ] );
+}  // end setThreshold
+
+int SignalEvents::find( Type type, int time, bool bForward ) const
+{
+	switch ( type )
+	{
+	case RisingCrossing:
+		return find( m_rising, time, bForward );
+	case FallingCrossing:
+		return find( m_falling, time, bForward );
+	case Crossing:
+	{
+		int rising = find( m_rising, time, bForward ),
+				falling = find( m_falling, time, bForward );
+		if ( rising < 0 || falling < 0 )
+			return qMax( rising, falling );
+		return bForward ? qMin( rising, falling ) : qMax( rising, falling );
+	}
+	case Extremum:
+		return find( m_extrema, time, bForward );
+	case Gap:
+		return find( m_gaps, time, bForward );
+	}
+	return -1;
+}  // end find
+
+int SignalEvents::count( Type type ) const
+{
+	switch ( type )
+	{
+	case RisingCrossing:
+		return m_rising.size();
+	case FallingCrossing:
+		return m_falling.size();
+	case Crossing:
+		return m_rising.size() + m_falling.size();
+	case Extremum:
+		return m_extrema.size();
+	case Gap:
+		return m_gaps.size();
+	}
+	return 0;
+}
+
+int SignalEvents::find( const QVector<qint32> &events, int time, bool bForward )
+{
+	if ( bForward )
+	{
+		const qint32 *pNext = std::upper_bound( events.constBegin(), events.constEnd(), time );
+		return pNext == events.constEnd() ? -1 : *pNext;
+	}
+
+	const qint32 *pNext = std::lower_bound( events.constBegin(), events.constEnd(), time );
+	return pNext == events.constBegin() ? -1 : *( pNext - 1 );
+}
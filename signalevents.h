@@ -0,0 +1,49 @@
+#ifndef SIGNALEVENTS_H
+#define SIGNALEVENTS_H
+
+#include <QVector>
+
+
+// sorted indexes of the events of a signal, used to jump from one event to the next in O(log n)
+// the events are the crossings of a threshold, the local extrema, and the gaps, which are runs of
+// missing (NaN) data points and are indexed by their 1st data point
+class SignalEvents
+{
+public:
+	enum Type
+	{
+		RisingCrossing,
+		FallingCrossing,
+		Crossing,  // either rising or falling
+		Extremum,
+		Gap
+	};
+
+	SignalEvents();
+
+	// indexes the local extrema, the gaps and the crossings of the given threshold of the
+	// given signal
+	void build( const QVector<float> &data, float threshold );
+
+	// indexes the crossings of the given threshold, a rising crossing is the 1st data point at or
+	// above the threshold after one below it, and a falling crossing the other way around
+	void setThreshold( const QVector<float> &data, float threshold );
+	float threshold() const { return m_threshold; }
+
+	// returns the time of the 1st event of the given type after, or before, the given time
+	// returns -1 if there is none
+	int find( Type type, int time, bool bForward ) const;
+
+	int count( Type type ) const;
+
+private:
+	static int find( const QVector<qint32> &events, int time, bool bForward );
+
+	float m_threshold;
+	QVector<qint32> m_rising;
+	QVector<qint32> m_falling;
+	QVector<qint32> m_extrema;
+	QVector<qint32> m_gaps;
+};
+
+#endif // SIGNALEVENTS_H
@@ -0,0 +1,838 @@
+#include "signalfilereader.h"
+#include "signalmemory.h"
+
+#include <QFile>
+#include <QThread>
+#include <QtConcurrent>
+
+#include <cstring>
+#include <limits>
+#include <memory>
+
+#include <zlib.h>
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+
+namespace
+{
+
+// the smallest number of bytes worth handing to a separate thread
+const qint64 s_minChunkSize = 1 << 20;
+
+// number of bytes decompressed before they are handed to a thread to parse
+const int s_decompressedChunkSize = 4 << 20;
+
+// powers of 10 that are exactly representable as doubles
+const double s_powersOf10[] =
+{ 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+  1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+// a range of whole lines of the file parsed by one thread
+struct ParseChunk
+{
+	QByteArray text;  // owns the lines of a decompressed chunk until they are parsed
+	const char *begin;
+	const char *end;
+	int dataPoints;  // number of data lines, counted before the chunk is parsed
+	QVector< float * > output;  // where the chunk goes in each column
+	QVector< QVector<float> > columns;  // holds the chunk when it is not parsed into the columns
+	QVector<float> smallestY;
+	QVector<float> largestY;
+	int lines;       // number of lines parsed, including blank lines
+	int errorLine;   // line of the 1st error relative to the chunk, -1 if none
+	bool bBadCount;  // true if the error is a wrong number of values, false if a non-number
+};
+
+inline bool isBlank( char c )
+{
+	return c == ' ' || c == '\t' || c == '\r';
+}
+
+// parses the whole of [begin, end) as a float in the C locale
+// returns false if the field is not a number
+bool parseField( const char *begin, const char *end, float &value )
+{
+	const char *p = begin;
+	bool bNegative = false;
+	if ( p < end && ( *p == '-' || *p == '+' ) )
+	{
+		bNegative = *p == '-';
+		p++;
+	}
+
+	// the common case of up to 15 significant digits and a small exponent is converted
+	// exactly w/ a single multiplication or division
+	quint64 mantissa = 0;
+	int digits = 0,
+		exponent = 0;
+	bool bAnyDigits = false;
+	for ( ; p < end && *p >= '0' && *p <= '9'; p++ )
+	{
+		bAnyDigits = true;
+		if ( digits < 19 )
+		{
+			mantissa = mantissa * 10 + ( *p - '0' );
+			if ( mantissa )
+				digits++;
+		}
+		else
+			exponent++;
+	}
+
+	if ( p < end && *p == '.' )
+	{
+		for ( p++; p < end && *p >= '0' && *p <= '9'; p++ )
+		{
+			bAnyDigits = true;
+			if ( digits < 19 )
+			{
+				mantissa = mantissa * 10 + ( *p - '0' );
+				if ( mantissa )
+					digits++;
+				exponent--;
+			}
+		}
+	}
+
+	if ( bAnyDigits && p < end && ( *p == 'e' || *p == 'E' ) )
+	{
+		p++;
+		bool bNegativeExponent = false;
+		if ( p < end && ( *p == '-' || *p == '+' ) )
+		{
+			bNegativeExponent = *p == '-';
+			p++;
+		}
+
+		int explicitExponent = 0;
+		bool bExponentDigits = false;
+		for ( ; p < end && *p >= '0' && *p <= '9'; p++ )
+		{
+			bExponentDigits = true;
+			if ( explicitExponent < 10000 )
+				explicitExponent = explicitExponent * 10 + ( *p - '0' );
+		}
+		if ( !bExponentDigits )
+			return false;
+		exponent += bNegativeExponent ? -explicitExponent : explicitExponent;
+	}
+
+	if ( bAnyDigits &&
+		 p == end &&
+		 digits <= 15 &&
+		 exponent >= -22 && exponent <= 22 )
+	{
+		double dValue = (double) mantissa;
+		if ( exponent < 0 )
+			dValue /= s_powersOf10[ -exponent ];
+		else
+			dValue *= s_powersOf10[ exponent ];
+		value = (float) ( bNegative ? -dValue : dValue );
+		return true;
+	}
+
+	// long mantissas, large exponents, nan and inf are rare enough to leave to Qt
+	bool bOk = false;
+	value = QByteArray( begin, int( end - begin ) ).toFloat( &bOk );
+	return bOk;
+}  // end parseField
+
+// returns the end of the field starting at p, which is either the delimiter or the end of line
+inline const char *fieldEnd( const char *p, const char *lineEnd, char delimiter )
+{
+	if ( delimiter == ' ' )
+	{
+		while ( p < lineEnd && !isBlank( *p ) )
+			p++;
+		return p;
+	}
+
+	const char *pDelimiter = (const char *) memchr( p, delimiter, lineEnd - p );
+	return pDelimiter ? pDelimiter : lineEnd;
+}
+
+// splits the given line into fields and calls handleField( index, begin, end ) for each one
+// returns the number of fields, or stops early and returns -1 if handleField() returns false
+template< typename FieldHandler >
+int splitLine( const char *p, const char *lineEnd, char delimiter, FieldHandler handleField )
+{
+	int field = 0;
+	if ( delimiter == ' ' )
+	{
+		while ( true )
+		{
+			while ( p < lineEnd && isBlank( *p ) )
+				p++;
+			if ( p == lineEnd )
+				return field;
+
+			const char *end = fieldEnd( p, lineEnd, delimiter );
+			if ( !handleField( field++, p, end ) )
+				return -1;
+			p = end;
+		}
+	}
+
+	while ( true )
+	{
+		const char *end = fieldEnd( p, lineEnd, delimiter );
+
+		// ignore the blanks around the field
+		const char *begin = p,
+				*last = end;
+		while ( begin < last && isBlank( *begin ) )
+			begin++;
+		while ( last > begin && isBlank( *( last - 1 ) ) )
+			last--;
+		if ( !handleField( field++, begin, last ) )
+			return -1;
+
+		if ( end == lineEnd )
+			return field;
+		p = end + 1;
+	}
+}  // end splitLine
+
+// returns true if the line holds nothing but blanks
+inline bool isBlankLine( const char *p, const char *lineEnd )
+{
+	while ( p < lineEnd && isBlank( *p ) )
+		p++;
+	return p == lineEnd;
+}
+
+inline const char *lineEnd( const char *p, const char *end )
+{
+	const char *pNewLine = (const char *) memchr( p, '\n', end - p );
+	return pNewLine ? pNewLine : end;
+}
+
+// picks the delimiter that splits the given line, preferring the most specific one
+char detectDelimiter( const char *p, const char *lineEnd )
+{
+	const char candidates[] = { ',', ';', '\t' };
+	for ( char candidate : candidates )
+	{
+		if ( memchr( p, candidate, lineEnd - p ) )
+			return candidate;
+	}
+	return ' ';
+}
+
+// counts the data lines of the given chunk, which are all the lines that are not blank
+void countChunk( ParseChunk &chunk )
+{
+	chunk.dataPoints = 0;
+	for ( const char *p = chunk.begin; p < chunk.end; )
+	{
+		const char *end = lineEnd( p, chunk.end );
+		if ( !isBlankLine( p, end ) )
+			chunk.dataPoints++;
+		p = end + 1;
+	}
+}
+
+// parses the lines of the given chunk into the columns it was given
+void parseChunk( ParseChunk &chunk, char delimiter, int numColumns )
+{
+	chunk.smallestY.fill( 1.0f, numColumns );
+	chunk.largestY.fill( -1.0f, numColumns );
+	chunk.lines = 0;
+	chunk.errorLine = -1;
+	chunk.bBadCount = false;
+
+	const char *p = chunk.begin;
+	const char *end = 0;
+	int dataPoint = 0;
+	for ( ; p < chunk.end; p = end + 1, chunk.lines++ )
+	{
+		end = lineEnd( p, chunk.end );
+		if ( isBlankLine( p, end ) )
+			continue;
+
+		bool bNonNumber = false;
+		int fields = splitLine( p, end, delimiter,
+								[&]( int field, const char *begin, const char *fieldEnd )
+		{
+			if ( field >= numColumns )
+				return false;
+
+			// an empty field between delimiters is a missing data point, a gap in the signal
+			float fData = 0.0f;
+			if ( begin == fieldEnd && delimiter != ' ' )
+				fData = std::numeric_limits<float>::quiet_NaN();
+			else if ( !parseField( begin, fieldEnd, fData ) )
+			{
+				bNonNumber = true;
+				return false;
+			}
+
+			if ( fData > chunk.largestY[ field ] )
+				chunk.largestY[ field ] = fData;
+			if ( fData < chunk.smallestY[ field ] )
+				chunk.smallestY[ field ] = fData;
+
+			chunk.output[ field ][ dataPoint ] = fData;
+			return true;
+		} );
+
+		if ( fields != numColumns )
+		{
+			chunk.errorLine = chunk.lines;
+			chunk.bBadCount = !bNonNumber;
+			return;
+		}
+		dataPoint++;
+	}  // end for each line
+}  // end parseChunk
+
+// sets sError to the 1st error of the given parsed chunks, firstDataLine being the line the 1st
+// chunk starts at
+// returns false if there is one
+bool checkChunks( const QVector< ParseChunk * > &chunks, int firstDataLine, QString &sError )
+{
+	int line = firstDataLine;
+	for ( const ParseChunk *pChunk : chunks )
+	{
+		if ( pChunk->errorLine >= 0 )
+		{
+			sError = pChunk->bBadCount
+					 ? QString( "Inconsistent number of values per line at line %1" )
+					 : QString( "Contains non-numbers at line %1" );
+			sError = sError.arg( line + pChunk->errorLine + 1 );
+			return false;
+		}
+		line += pChunk->lines;
+	}
+
+	return true;
+}
+
+// makes sure a file has the expected number of data points, 0 taking any number, or while it
+// is still being read, that it does not have more than that
+// returns false and sets sError otherwise
+bool checkDataPoints( qint64 dataPoints, int expectedDataPoints, bool bComplete, QString &sError )
+{
+	if ( expectedDataPoints &&
+		 ( bComplete ? dataPoints != expectedDataPoints : dataPoints > expectedDataPoints ) )
+	{
+		sError = "Number of data points is not the same as that of previously loaded files";
+		return false;
+	}
+	if ( dataPoints > std::numeric_limits<int>::max() )
+	{
+		sError = "Too many data points";
+		return false;
+	}
+
+	return true;
+}  // end checkDataPoints
+
+// reserves in the budget the memory the store will take for numColumns columns of dataPoints
+// data points, which also covers parsing them, so that a file the store would reject for its
+// size is rejected before it is parsed, and adds it to reserved
+// returns false, and reserves nothing, if it does not fit
+bool reserveColumns( qint64 dataPoints, int numColumns, qint64 &reserved, QString &sError )
+{
+	qint64 bytes = SignalMemory::signalBytes( dataPoints ) * numColumns;
+	if ( !SignalMemory::reserve( bytes ) )
+	{
+		sError = QString( "Not enough memory within the budget of %1 MB for the signals" )
+				 .arg( SignalMemory::budget() >> 20 );
+		return false;
+	}
+
+	reserved += bytes;
+	return true;
+}  // end reserveColumns
+
+// gathers the given parsed chunks into a single vector per column, a column at a time, freeing
+// the parts of each column as soon as they are copied so that the chunks and the columns are
+// never both held in full
+void gatherChunks( const QVector< ParseChunk * > &chunks,
+				   int dataPoints,
+				   int numColumns,
+				   QVector< QVector<float> > &columns,
+				   QVector<float> &smallestY,
+				   QVector<float> &largestY )
+{
+	columns.resize( numColumns );
+	smallestY.fill( 1.0f, numColumns );
+	largestY.fill( -1.0f, numColumns );
+	for ( int ii=0; ii<numColumns; ii++ )
+	{
+		QVector<float> &column = columns[ ii ];
+		SignalMemory::allocate( column, dataPoints );
+		float *pData = column.data();
+		for ( ParseChunk *pChunk : chunks )
+		{
+			QVector<float> &chunkColumn = pChunk->columns[ ii ];
+			memcpy( pData, chunkColumn.constData(), chunkColumn.size() * sizeof( float ) );
+			pData += chunkColumn.size();
+			chunkColumn = QVector<float>();
+
+			smallestY[ ii ] = qMin( smallestY.at( ii ), pChunk->smallestY.at( ii ) );
+			largestY[ ii ] = qMax( largestY.at( ii ), pChunk->largestY.at( ii ) );
+		}
+	}
+}  // end gatherChunks
+
+
+enum Compression
+{
+	Uncompressed,
+	Gzip,
+	Zstd
+};
+
+// tells the compression of a file from its magic number
+Compression detectCompression( const char *begin, qint64 size )
+{
+	const uchar *p = (const uchar *) begin;
+	if ( size >= 2 && p[ 0 ] == 0x1f && p[ 1 ] == 0x8b )
+		return Gzip;
+	if ( size >= 4 && p[ 0 ] == 0x28 && p[ 1 ] == 0xb5 && p[ 2 ] == 0x2f && p[ 3 ] == 0xfd )
+		return Zstd;
+	return Uncompressed;
+}
+
+// decompresses a gzip or zstd file held in memory a chunk at a time, concatenated gzip members
+// and zstd frames included
+class Decompressor
+{
+public:
+	Decompressor( Compression compression, const char *begin, qint64 size );
+	~Decompressor();
+
+	// appends up to maxBytes decompressed bytes to text
+	// returns false and sets sError if the data is corrupt or truncated, or the compression
+	// is not supported by this build
+	bool decompress( QByteArray &text, int maxBytes, QString &sError );
+	bool atEnd() const { return m_bAtEnd; }
+
+private:
+	Compression m_compression;
+	const char *m_begin;
+	qint64 m_size;
+	qint64 m_consumed;
+	bool m_bAtEnd;
+
+	z_stream m_gzip;
+#ifdef HAVE_ZSTD
+	ZSTD_DStream *m_pZstd;
+#endif
+};
+
+Decompressor::Decompressor( Compression compression, const char *begin, qint64 size )
+	: m_compression( compression ),
+	  m_begin( begin ),
+	  m_size( size ),
+	  m_consumed( 0 ),
+	  m_bAtEnd( false )
+{
+	memset( &m_gzip, 0, sizeof( m_gzip ) );
+	if ( m_compression == Gzip )
+		inflateInit2( &m_gzip, 15 + 16 );
+#ifdef HAVE_ZSTD
+	m_pZstd = m_compression == Zstd ? ZSTD_createDStream() : 0;
+	if ( m_pZstd )
+		ZSTD_initDStream( m_pZstd );
+#endif
+}
+
+Decompressor::~Decompressor()
+{
+	if ( m_compression == Gzip )
+		inflateEnd( &m_gzip );
+#ifdef HAVE_ZSTD
+	if ( m_pZstd )
+		ZSTD_freeDStream( m_pZstd );
+#endif
+}
+
+bool Decompressor::decompress( QByteArray &text, int maxBytes, QString &sError )
+{
+	int oldSize = text.size();
+	text.resize( oldSize + maxBytes );
+	char *pOut = text.data() + oldSize;
+	int produced = 0;
+
+	if ( m_compression == Gzip )
+	{
+		m_gzip.next_out = (Bytef *) pOut;
+		m_gzip.avail_out = maxBytes;
+		while ( m_gzip.avail_out && !m_bAtEnd )
+		{
+			// zlib takes at most 4GB of input at a time
+			if ( !m_gzip.avail_in )
+			{
+				uInt available = (uInt) qMin( m_size - m_consumed, (qint64) 1 << 30 );
+				m_gzip.next_in = (Bytef *) ( m_begin + m_consumed );
+				m_gzip.avail_in = available;
+				m_consumed += available;
+			}
+
+			int result = inflate( &m_gzip, Z_NO_FLUSH );
+			if ( result == Z_STREAM_END )
+			{
+				// another member may follow
+				if ( m_gzip.avail_in || m_consumed < m_size )
+					inflateReset( &m_gzip );
+				else
+					m_bAtEnd = true;
+			}
+			else if ( result != Z_OK )
+			{
+				sError = result == Z_BUF_ERROR ? "Compressed data is truncated" : "Compressed data is corrupt";
+				return false;
+			}
+		}
+		produced = maxBytes - m_gzip.avail_out;
+	}
+
+	else if ( m_compression == Zstd )
+	{
+#ifdef HAVE_ZSTD
+		ZSTD_inBuffer input = { m_begin, (size_t) m_size, (size_t) m_consumed };
+		ZSTD_outBuffer output = { pOut, (size_t) maxBytes, 0 };
+		while ( output.pos < output.size && !m_bAtEnd )
+		{
+			size_t result = ZSTD_decompressStream( m_pZstd, &output, &input );
+			if ( ZSTD_isError( result ) )
+			{
+				sError = "Compressed data is corrupt";
+				return false;
+			}
+
+			// a result of 0 ends a frame, another one may follow
+			if ( input.pos == input.size )
+			{
+				if ( !result )
+					m_bAtEnd = true;
+				else if ( output.pos < output.size )
+				{
+					sError = "Compressed data is truncated";
+					return false;
+				}
+			}
+		}
+		m_consumed = input.pos;
+		produced = (int) output.pos;
+#else
+		sError = "Reading zstd compressed files is not supported by this build";
+		return false;
+#endif
+	}
+
+	text.resize( oldSize + produced );
+	return true;
+}  // end decompress
+
+}  // end anonymous namespace
+
+
+SignalFileReader::SignalFileReader()
+	: m_delimiter( '\0' ),
+	  m_bHeaderRow( false ),
+	  m_expectedDataPoints( 0 )
+{
+
+}
+
+bool SignalFileReader::read( const QString &filename,
+							 QVector< QVector<float> > &columns,
+							 QVector<float> &smallestY,
+							 QVector<float> &largestY,
+							 QString &sError )
+{
+	QFile file( filename );
+	if ( !file.open( QIODevice::ReadOnly ) )
+	{
+		sError = QString( "Could not open file: " ).append( filename );
+		return false;
+	}
+
+	// map the file if possible so the threads parse straight out of the page cache
+	QByteArray contents;
+	const char *begin = 0;
+	qint64 size = file.size();
+	if ( size > 0 )
+		begin = (const char *) file.map( 0, size );
+	if ( !begin )
+	{
+		contents = file.readAll();
+		begin = contents.constData();
+		size = contents.size();
+	}
+
+	bool bOk = detectCompression( begin, size ) == Uncompressed
+			   ? parse( begin, begin + size, columns, smallestY, largestY, sError )
+			   : parseCompressed( begin, size, columns, smallestY, largestY, sError );
+	file.close();
+
+	if ( !bOk )
+		sError.append( ". Ignored: " ).append( filename );
+	return bOk;
+}  // end read
+
+bool SignalFileReader::parse( const char *begin,
+							  const char *end,
+							  QVector< QVector<float> > &columns,
+							  QVector<float> &smallestY,
+							  QVector<float> &largestY,
+							  QString &sError )
+{
+	columns.clear();
+	smallestY.clear();
+	largestY.clear();
+
+	int firstDataLine = 0,
+			numColumns = 0;
+	char delimiter = '\0';
+	const char *p = findData( begin, end, firstDataLine, delimiter, numColumns );
+	if ( !p )
+	{
+		sError = "Contains no data";
+		return false;
+	}
+
+	// split the data lines into chunks of whole lines, one or more per thread
+	qint64 size = end - p;
+	int numChunks = (int) qBound( (qint64) 1, size / s_minChunkSize,
+								  (qint64) QThread::idealThreadCount() * 4 );
+	QVector< ParseChunk > chunks( numChunks );
+	const char *chunkBegin = p;
+	for ( int ii=0; ii<numChunks; ii++ )
+	{
+		const char *chunkEnd = end;
+		if ( ii < numChunks - 1 )
+		{
+			chunkEnd = p + size * ( ii + 1 ) / numChunks;
+			if ( chunkEnd < chunkBegin )
+				chunkEnd = chunkBegin;
+			chunkEnd = qMin( lineEnd( chunkEnd, end ) + 1, end );
+		}
+		chunks[ ii ].begin = chunkBegin;
+		chunks[ ii ].end = chunkEnd;
+		chunkBegin = chunkEnd;
+	}
+
+	// count the data lines 1st, which only looks for the ends of lines, so that the columns are
+	// allocated once and only for a file that has the right number of data points and fits
+	QtConcurrent::blockingMap( chunks, []( ParseChunk &chunk )
+	{
+		countChunk( chunk );
+	} );
+
+	qint64 dataPoints = 0;
+	for ( const ParseChunk &chunk : chunks )
+		dataPoints += chunk.dataPoints;
+	qint64 reserved = 0;
+	if ( !checkDataPoints( dataPoints, m_expectedDataPoints, true, sError ) ||
+		 !reserveColumns( dataPoints, numColumns, reserved, sError ) )
+		return false;
+
+	// every chunk parses straight into its part of the columns
+	columns.resize( numColumns );
+	for ( int ii=0; ii<numColumns; ii++ )
+		SignalMemory::allocate( columns[ ii ], (int) dataPoints );
+	int firstDataPoint = 0;
+	for ( ParseChunk &chunk : chunks )
+	{
+		chunk.output.resize( numColumns );
+		for ( int ii=0; ii<numColumns; ii++ )
+			chunk.output[ ii ] = columns[ ii ].data() + firstDataPoint;
+		firstDataPoint += chunk.dataPoints;
+	}
+
+	QtConcurrent::blockingMap( chunks, [=]( ParseChunk &chunk )
+	{
+		parseChunk( chunk, delimiter, numColumns );
+	} );
+
+	// the reservation only covers the parsing, the store the columns go to reserves their
+	// memory for as long as it holds them
+	SignalMemory::release( reserved );
+
+	QVector< ParseChunk * > parsedChunks;
+	for ( ParseChunk &chunk : chunks )
+		parsedChunks.push_back( &chunk );
+	if ( !checkChunks( parsedChunks, firstDataLine, sError ) )
+	{
+		columns.clear();
+		return false;
+	}
+
+	smallestY.fill( 1.0f, numColumns );
+	largestY.fill( -1.0f, numColumns );
+	for ( const ParseChunk &chunk : chunks )
+	{
+		for ( int ii=0; ii<numColumns; ii++ )
+		{
+			smallestY[ ii ] = qMin( smallestY.at( ii ), chunk.smallestY.at( ii ) );
+			largestY[ ii ] = qMax( largestY.at( ii ), chunk.largestY.at( ii ) );
+		}
+	}
+
+	return true;
+}  // end parse
+
+// decompresses the file one chunk at a time and hands the whole lines of each chunk to a
+// thread to parse while the next chunk is decompressed, so the file is read in about the time the
+// decompression alone takes, w/ at most a couple of chunks per thread decompressed and waiting
+// to be parsed at any time
+bool SignalFileReader::parseCompressed( const char *begin,
+										qint64 size,
+										QVector< QVector<float> > &columns,
+										QVector<float> &smallestY,
+										QVector<float> &largestY,
+										QString &sError )
+{
+	columns.clear();
+	smallestY.clear();
+	largestY.clear();
+
+	Decompressor decompressor( detectCompression( begin, size ), begin, size );
+	QVector< std::shared_ptr< ParseChunk > > chunks;
+	QVector< QFuture<void> > futures;
+	int parsedFutures = 0;
+
+	// the data points are counted, and their memory reserved, chunk by chunk as they are
+	// decompressed, so a file w/ too many data points or too big for the budget is rejected as
+	// soon as it goes over
+	qint64 dataPoints = 0,
+			reserved = 0;
+	auto abort = [&]()
+	{
+		for ( QFuture<void> &future : futures )
+			future.waitForFinished();
+		SignalMemory::release( reserved );
+		return false;
+	};
+
+	// text holds the bytes decompressed but not handed to a thread yet, which is the partial
+	// line at the end of the last chunk, or everything until the 1st data line is complete
+	QByteArray text;
+	int firstDataLine = 0,
+			numColumns = 0;
+	char delimiter = '\0';
+	bool bFoundData = false;
+	while ( !decompressor.atEnd() )
+	{
+		if ( !decompressor.decompress( text, s_decompressedChunkSize, sError ) )
+			return abort();
+
+		int wholeLines = decompressor.atEnd() ? text.size() : text.lastIndexOf( '\n' ) + 1;
+		const char *pText = text.constData(),
+				*p = pText;
+		if ( !bFoundData )
+		{
+			p = findData( pText, pText + wholeLines, firstDataLine, delimiter, numColumns );
+			if ( !p )
+				continue;
+			bFoundData = true;
+		}
+		if ( p == pText + wholeLines )
+			continue;
+
+		// the chunk takes over the decompressed bytes and text keeps the partial line
+		std::shared_ptr< ParseChunk > chunk = std::make_shared< ParseChunk >();
+		chunk->text = text;
+		chunk->begin = chunk->text.constData() + ( p - pText );
+		chunk->end = chunk->text.constData() + wholeLines;
+		text = QByteArray( pText + wholeLines, text.size() - wholeLines );
+
+		countChunk( *chunk );
+		dataPoints += chunk->dataPoints;
+		if ( !checkDataPoints( dataPoints, m_expectedDataPoints, false, sError ) ||
+			 !reserveColumns( chunk->dataPoints, numColumns, reserved, sError ) )
+			return abort();
+
+		// the chunk parses into columns of its own, allocated once it is counted
+		chunk->columns.resize( numColumns );
+		chunk->output.resize( numColumns );
+		for ( int ii=0; ii<numColumns; ii++ )
+		{
+			chunk->columns[ ii ].resize( chunk->dataPoints );
+			chunk->output[ ii ] = chunk->columns[ ii ].data();
+		}
+		chunks.push_back( chunk );
+
+		futures.push_back( QtConcurrent::run( [=]()
+		{
+			parseChunk( *chunk, delimiter, numColumns );
+			chunk->text.clear();
+		} ) );
+
+		// once there are enough chunks queued to keep every thread busy, wait for the oldest
+		// one so that the text waiting to be parsed stays bounded when decompressing is faster
+		// than parsing
+		while ( futures.size() - parsedFutures > 2 * QThread::idealThreadCount() )
+			futures[ parsedFutures++ ].waitForFinished();
+	}  // end while decompressing
+
+	if ( chunks.isEmpty() )
+	{
+		sError = "Contains no data";
+		return abort();
+	}
+
+	QVector< ParseChunk * > parsedChunks;
+	for ( const std::shared_ptr< ParseChunk > &chunk : chunks )
+		parsedChunks.push_back( chunk.get() );
+	for ( QFuture<void> &future : futures )
+		future.waitForFinished();
+	if ( !checkChunks( parsedChunks, firstDataLine, sError ) ||
+		 !checkDataPoints( dataPoints, m_expectedDataPoints, true, sError ) )
+		return abort();
+
+	gatherChunks( parsedChunks, (int) dataPoints, numColumns, columns, smallestY, largestY );
+
+	// the reservation only covers the parsing, the store the columns go to reserves their
+	// memory for as long as it holds them
+	SignalMemory::release( reserved );
+	return true;
+}  // end parseCompressed
+
+// skips the byte order mark, the blank lines and the header to find the 1st data line of
+// [begin, end), which decides the delimiter and the number of columns
+// returns the 1st data line, or 0 if there is none
+const char *SignalFileReader::findData( const char *begin,
+										const char *end,
+										int &firstDataLine,
+										char &delimiter,
+										int &numColumns ) const
+{
+	// spreadsheets often start their UTF-8 exports w/ a byte order mark
+	if ( end - begin >= 3 && !memcmp( begin, "\xEF\xBB\xBF", 3 ) )
+		begin += 3;
+
+	firstDataLine = 0;
+	const char *p = begin;
+	bool bHeaderPending = m_bHeaderRow;
+	while ( p < end )
+	{
+		const char *pEnd = lineEnd( p, end );
+		if ( !isBlankLine( p, pEnd ) )
+		{
+			if ( !bHeaderPending )
+				break;
+			bHeaderPending = false;
+		}
+		p = pEnd + 1;
+		firstDataLine++;
+	}
+
+	if ( p >= end )
+		return 0;
+
+	const char *pFirstEnd = lineEnd( p, end );
+	delimiter = m_delimiter ? m_delimiter : detectDelimiter( p, pFirstEnd );
+	numColumns = splitLine( p, pFirstEnd, delimiter,
+							[]( int, const char *, const char * ) { return true; } );
+	Q_ASSERT( numColumns > 0 );
+
+	return p;
+}  // end findData
@@ -0,0 +1,76 @@
+#ifndef SIGNALFILEREADER_H
+#define SIGNALFILEREADER_H
+
+#include <QVector>
+#include <QString>
+
+
+// reads text signal files that hold one sample per line and one signal per column
+// the columns are separated by a single delimiter character, or by any run of spaces and tabs
+// if the delimiter is ' '
+// missing data points, either empty fields between delimiters or "nan", are read as NaN
+// gzip and zstd compressed files are read directly, w/o a temporary file
+// the file is split into chunks of whole lines that are parsed in parallel, so all the
+// columns of the file are read in a single pass over its bytes
+// the data lines are counted before anything is allocated for them, so a file w/ the wrong
+// number of data points or too big for the memory budget is rejected early, and each column of
+// an uncompressed file is then allocated once and parsed straight into
+class SignalFileReader
+{
+public:
+	SignalFileReader();
+
+	// '\0' detects the delimiter from the first data line, one of ',', ';', '\t' or ' '
+	void setDelimiter( char delimiter ) { m_delimiter = delimiter; }
+	char delimiter() const { return m_delimiter; }
+
+	// true if the first line of the file holds the column names instead of data
+	void setHeaderRow( bool bHeaderRow ) { m_bHeaderRow = bHeaderRow; }
+	bool headerRow() const { return m_bHeaderRow; }
+
+	// number of data points the files must have, 0 for any number
+	void setExpectedDataPoints( int dataPoints ) { m_expectedDataPoints = dataPoints; }
+	int expectedDataPoints() const { return m_expectedDataPoints; }
+
+	// reads every column of the given file into its own vector, along w/ the smallest and
+	// largest value of each column
+	// returns false and sets sError if the file could not be opened or is formatted incorrectly
+	bool read( const QString &filename,
+			   QVector< QVector<float> > &columns,
+			   QVector<float> &smallestY,
+			   QVector<float> &largestY,
+			   QString &sError );
+
+	// parses a buffer holding the contents of a signal file, see read()
+	bool parse( const char *begin,
+				const char *end,
+				QVector< QVector<float> > &columns,
+				QVector<float> &smallestY,
+				QVector<float> &largestY,
+				QString &sError );
+
+	// decompresses a buffer holding a gzip or zstd compressed signal file while parsing it,
+	// see read()
+	// the number of data points is only known once the file is decompressed, so each chunk
+	// is counted and checked against it and the budget as it is decompressed, parsed into
+	// columns of its own, then the chunks are gathered a column at a time
+	bool parseCompressed( const char *begin,
+						  qint64 size,
+						  QVector< QVector<float> > &columns,
+						  QVector<float> &smallestY,
+						  QVector<float> &largestY,
+						  QString &sError );
+
+private:
+	const char *findData( const char *begin,
+						  const char *end,
+						  int &firstDataLine,
+						  char &delimiter,
+						  int &numColumns ) const;
+
+	char m_delimiter;
+	bool m_bHeaderRow;
+	int m_expectedDataPoints;
+};
+
+#endif // SIGNALFILEREADER_H
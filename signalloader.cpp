@@ -0,0 +1,85 @@
+#include "signalloader.h"
+#include "signalstore.h"
+#include "signalcache.h"
+#include "chartlayout.h"
+
+#include <QtConcurrent>
+
+
+bool SignalLoader::readFile( const QString &filename,
+							 const SignalFileReader &reader,
+							 QVector< QVector<float> > &columns,
+							 QVector< SignalSummary > &summaries,
+							 QString &sError,
+							 bool bWriteCache )  // def true
+{
+	char delimiter = reader.delimiter();
+	bool bHeaderRow = reader.headerRow();
+	if ( SignalCache::load( filename, delimiter, bHeaderRow, reader.expectedDataPoints(),
+							columns, summaries, sError ) )
+		return true;
+	if ( !sError.isEmpty() )
+		return false;
+
+	SignalFileReader fileReader( reader );
+	QVector<float> smallestY,
+			largestY;
+	if ( !fileReader.read( filename, columns, smallestY, largestY, sError ) )
+		return false;
+
+	summaries.resize( columns.count() );
+	for ( int ii=0; ii<columns.count(); ii++ )
+	{
+		summaries[ ii ].build( columns.at( ii ), smallestY.at( ii ), largestY.at( ii ) );
+		summaries[ ii ].setScale( ChartLayout::signalScale( smallestY.at( ii ), largestY.at( ii ) ) );
+	}
+
+	if ( !bWriteCache )
+		return true;
+
+	// write the cache in the background, the copies of the columns share their data w/ the
+	// caller so this costs no memory unless the caller lets go of them first
+	QtConcurrent::run( [=]()
+	{
+		SignalCache::save( filename, delimiter, bHeaderRow, columns, summaries );
+	} );
+
+	return true;
+}  // end readFile
+
+bool SignalLoader::addFile( const QString &filename,
+							const SignalFileReader &reader,
+							SignalStore &store,
+							QString &sError )
+{
+	// only allow loading 7 signals -- this is an artificial limit based on the number of
+	// colors I defined for the signals -- otherwise, there is no limit
+	// this only saves reading a file when the store is already full, the store enforcing the
+	// limit when the columns are added
+	SignalSnapshotPtr snapshot = store.snapshot();
+	if ( snapshot->signalCount() + 1 > ChartLayout::s_maxSignals )
+	{
+		sError = QString( "Maximum number of signal files already loaded. Ignored: " ).append( filename );
+		return false;
+	}
+
+	// a file w/ a different number of data points than the signals already loaded is rejected
+	// before its columns are allocated
+	SignalFileReader fileReader( reader );
+	fileReader.setExpectedDataPoints( snapshot->numDataPoints );
+	QVector< QVector<float> > columns;
+	QVector< SignalSummary > summaries;
+	if ( !readFile( filename, fileReader, columns, summaries, sError ) )
+		return false;
+
+	// the store makes sure the number of data points in all files is consistent, and that there
+	// are colors for all the signals
+	if ( !store.addSignals( columns, summaries, sError ) )
+	{
+		sError.append( ". Ignored: " );
+		sError.append( filename );
+		return false;
+	}
+
+	return true;
+}  // end addFile
@@ -0,0 +1,42 @@
+#ifndef SIGNALLOADER_H
+#define SIGNALLOADER_H
+
+#include <QVector>
+#include <QString>
+
+#include "signalfilereader.h"
+#include "signalsummary.h"
+
+class SignalStore;
+
+
+// loads signal files the same way for the chart, the batch renderer and the replay of traces:
+// from the sidecar cache if the file has an up to date one, otherwise by parsing it and
+// writing the cache in the background
+// errors are returned rather than displayed, so that the callers w/o a user to show them to
+// get the same checks in the same order
+class SignalLoader
+{
+public:
+	// reads every column of the given file w/ the given reader, along w/ their summaries and
+	// scales
+	// the cache of a file that had to be parsed is only written if bWriteCache is true, since
+	// it holds the samples uncompressed and is worth its size only for files read again
+	// returns false and sets sError if the file could not be read
+	static bool readFile( const QString &filename,
+						  const SignalFileReader &reader,
+						  QVector< QVector<float> > &columns,
+						  QVector< SignalSummary > &summaries,
+						  QString &sError,
+						  bool bWriteCache = true );
+
+	// reads the given file and adds its columns to the store as new signals
+	// returns false and sets sError if the file could not be read or the store rejected its
+	// columns, for their number of data points, the colors left or the memory budget
+	static bool addFile( const QString &filename,
+						 const SignalFileReader &reader,
+						 SignalStore &store,
+						 QString &sError );
+};
+
+#endif // SIGNALLOADER_H
@@ -0,0 +1,93 @@
+#include "signalmemory.h"
+
+#include <atomic>
+
+#ifdef Q_OS_UNIX
+#include <unistd.h>
+#endif
+#ifdef Q_OS_LINUX
+#include <sys/mman.h>
+#endif
+
+
+namespace
+{
+
+// transparent huge pages are 2MB on the systems that have them
+const quintptr s_hugePageSize = 2 << 20;
+
+// returns the bytes of physical memory, or 0 if unknown
+qint64 physicalMemory()
+{
+#if defined( Q_OS_UNIX ) && defined( _SC_PHYS_PAGES )
+	long pages = sysconf( _SC_PHYS_PAGES ),
+			pageSize = sysconf( _SC_PAGESIZE );
+	if ( pages > 0 && pageSize > 0 )
+		return (qint64) pages * pageSize;
+#endif
+	return 0;
+}
+
+std::atomic< qint64 > s_budget( physicalMemory() / 4 * 3 );
+std::atomic< qint64 > s_used( 0 );
+
+}  // end anonymous namespace
+
+
+void SignalMemory::setBudget( qint64 bytes )
+{
+	s_budget = qMax( bytes, (qint64) 0 );
+}
+
+qint64 SignalMemory::budget()
+{
+	return s_budget;
+}
+
+qint64 SignalMemory::used()
+{
+	return s_used;
+}
+
+bool SignalMemory::reserve( qint64 bytes )
+{
+	qint64 used = s_used;
+	do
+	{
+		qint64 budget = s_budget;
+		if ( budget && used + bytes > budget )
+			return false;
+	}
+	while ( !s_used.compare_exchange_weak( used, used + bytes ) );
+
+	return true;
+}
+
+void SignalMemory::release( qint64 bytes )
+{
+	s_used -= bytes;
+}
+
+qint64 SignalMemory::signalBytes( qint64 dataPoints )
+{
+	// the data, the prefix sums and squares of the statistics, their counts of missing data
+	// points, and about a byte for the pyramid of the summary and the event indexes
+	return dataPoints * ( sizeof( float ) + 2 * sizeof( double ) + sizeof( qint32 ) + 1 );
+}
+
+void SignalMemory::allocate( QVector<float> &data, int dataPoints )
+{
+	data = QVector<float>();
+	data.reserve( dataPoints );
+
+#if defined( Q_OS_LINUX ) && defined( MADV_HUGEPAGE )
+	// nothing has touched the allocation yet, so the pages resize() faults in can be huge ones
+	// only the huge pages that fit entirely within the data are asked for
+	quintptr begin = ( (quintptr) data.constData() + s_hugePageSize - 1 ) & ~( s_hugePageSize - 1 ),
+			end = (quintptr) ( data.constData() + dataPoints ) & ~( s_hugePageSize - 1 );
+	if ( end > begin )
+		madvise( (void *) begin, end - begin, MADV_HUGEPAGE );
+#endif
+
+	data.resize( dataPoints );
+}  // end allocate
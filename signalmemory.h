@@ -0,0 +1,34 @@
+#ifndef SIGNALMEMORY_H
+#define SIGNALMEMORY_H
+
+#include <QVector>
+#include <QtGlobal>
+
+
+// process wide budget for the memory taken by signal data, shared by every reader and store
+// loading a file that would go over the budget fails w/ an error instead of letting the machine
+// swap, the default budget being three quarters of the physical memory
+// the bytes are reserved before they are allocated and released once they are freed, or for
+// the data held by a store, once the store lets go of it
+class SignalMemory
+{
+public:
+	// a budget of 0 means no limit
+	static void setBudget( qint64 bytes );
+	static qint64 budget();
+	static qint64 used();
+
+	// returns false, and reserves nothing, if reserving bytes would go over the budget
+	static bool reserve( qint64 bytes );
+	static void release( qint64 bytes );
+
+	// bytes a store holds for a signal of the given number of data points, the data along w/
+	// its statistics, summary and event indexes
+	static qint64 signalBytes( qint64 dataPoints );
+
+	// sizes data to the given number of data points w/ a single allocation, which is backed by
+	// huge pages where the system has them so that long signals take fewer TLB entries
+	static void allocate( QVector<float> &data, int dataPoints );
+};
+
+#endif // SIGNALMEMORY_H
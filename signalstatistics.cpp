@@ -0,0 +1,189 @@
+#include "signalstatistics.h"
+
+#include <QThread>
+#include <QtConcurrent>
+
+#include <cmath>
+
+
+namespace
+{
+
+// sum w/ Kahan compensation
+struct CompensatedSum
+{
+	CompensatedSum( double start = 0.0 ) : sum( start ), compensation( 0.0 ) {}
+
+	void add( double value )
+	{
+		double y = value - compensation;
+		double t = sum + y;
+		compensation = ( t - sum ) - y;
+		sum = t;
+	}
+
+	double sum;
+	double compensation;
+};
+
+// range of data points whose prefix sums are filled in by one thread
+struct PrefixChunk
+{
+	int first;
+	int last;
+	int missing;
+	CompensatedSum sum;
+	CompensatedSum squares;
+};
+
+}  // end anonymous namespace
+
+
+SignalStatistics::SignalStatistics()
+	: m_offset( 0.0 )
+{
+
+}
+
+void SignalStatistics::build( const QVector<float> &data )
+{
+	int count = data.size();
+	m_offset = 0.0;
+	m_sums.clear();
+	m_squares.clear();
+	m_counts.clear();
+	if ( !count )
+		return;
+
+	const float *pData = data.constData();
+	int numChunks = qMax( 1, qMin( count / 65536, QThread::idealThreadCount() * 4 ) );
+	QVector< PrefixChunk > chunks( numChunks );
+	for ( int ii=0; ii<numChunks; ii++ )
+	{
+		chunks[ ii ].first = (int) ( (qint64) count * ii / numChunks );
+		chunks[ ii ].last = (int) ( (qint64) count * ( ii + 1 ) / numChunks );
+	}
+
+	// the sums are taken relative to the mean so the sums of squares don't swamp the variance,
+	// which takes a pass of its own
+	QtConcurrent::blockingMap( chunks, [=]( PrefixChunk &chunk )
+	{
+		chunk.missing = 0;
+		for ( int ii=chunk.first; ii<chunk.last; ii++ )
+		{
+			if ( pData[ ii ] != pData[ ii ] )
+				chunk.missing++;
+			else
+				chunk.sum.add( pData[ ii ] );
+		}
+	} );
+	CompensatedSum total;
+	int missing = 0;
+	for ( const PrefixChunk &chunk : chunks )
+	{
+		total.add( chunk.sum.sum );
+		missing += chunk.missing;
+	}
+	if ( missing < count )
+		m_offset = total.sum / ( count - missing );
+
+	// the total of each chunk
+	double offset = m_offset;
+	QtConcurrent::blockingMap( chunks, [=]( PrefixChunk &chunk )
+	{
+		chunk.sum = CompensatedSum();
+		chunk.squares = CompensatedSum();
+		for ( int ii=chunk.first; ii<chunk.last; ii++ )
+		{
+			if ( pData[ ii ] != pData[ ii ] )
+				continue;
+			double value = pData[ ii ] - offset;
+			chunk.sum.add( value );
+			chunk.squares.add( value * value );
+		}
+	} );
+
+	// each chunk starts from the total of the chunks before it
+	CompensatedSum sum,
+			squares;
+	int valid = 0;
+	for ( PrefixChunk &chunk : chunks )
+	{
+		CompensatedSum chunkSum = chunk.sum,
+				chunkSquares = chunk.squares;
+		chunk.sum = sum;
+		chunk.squares = squares;
+		sum.add( chunkSum.sum );
+		squares.add( chunkSquares.sum );
+
+		// from here on missing holds the number of valid data points before the chunk
+		int chunkValid = chunk.last - chunk.first - chunk.missing;
+		chunk.missing = valid;
+		valid += chunkValid;
+	}
+
+	// the prefix sums themselves
+	m_sums.resize( count + 1 );
+	m_squares.resize( count + 1 );
+	m_sums[ 0 ] = 0.0;
+	m_squares[ 0 ] = 0.0;
+	if ( missing )
+	{
+		m_counts.resize( count + 1 );
+		m_counts[ 0 ] = 0;
+	}
+	double *pSums = m_sums.data(),
+			*pSquares = m_squares.data();
+	qint32 *pCounts = missing ? m_counts.data() : 0;
+	QtConcurrent::blockingMap( chunks, [=]( PrefixChunk &chunk )
+	{
+		int valid = chunk.missing;
+		for ( int ii=chunk.first; ii<chunk.last; ii++ )
+		{
+			if ( pData[ ii ] == pData[ ii ] )
+			{
+				double value = pData[ ii ] - offset;
+				chunk.sum.add( value );
+				chunk.squares.add( value * value );
+				valid++;
+			}
+			pSums[ ii + 1 ] = chunk.sum.sum;
+			pSquares[ ii + 1 ] = chunk.squares.sum;
+			if ( pCounts )
+				pCounts[ ii + 1 ] = valid;
+		}
+	} );
+}  // end build
+
+SignalRangeStatistics SignalStatistics::range( const QVector<float> &data, int first, int last ) const
+{
+	Q_ASSERT( first >= 0 && first <= last && last + 1 < m_sums.size() );
+
+	SignalRangeStatistics statistics;
+	statistics.count = m_counts.isEmpty() ? last - first + 1
+										  : m_counts.at( last + 1 ) - m_counts.at( first );
+	if ( !statistics.count )
+	{
+		// nothing but missing data points
+		statistics.mean = statistics.rms = statistics.standardDeviation = statistics.area = 0.0;
+		return statistics;
+	}
+
+	double n = statistics.count,
+			sum = m_sums.at( last + 1 ) - m_sums.at( first ),
+			squares = m_squares.at( last + 1 ) - m_squares.at( first );
+	double shiftedMean = sum / n;
+	double variance = qMax( 0.0, squares / n - shiftedMean * shiftedMean );
+
+	statistics.mean = m_offset + shiftedMean;
+	statistics.standardDeviation = sqrt( variance );
+	statistics.rms = sqrt( variance + statistics.mean * statistics.mean );
+
+	// the end points of the trapezoidal rule only count half
+	statistics.area = sum + n * m_offset;
+	if ( data.at( first ) == data.at( first ) )
+		statistics.area -= 0.5 * data.at( first );
+	if ( data.at( last ) == data.at( last ) )
+		statistics.area -= 0.5 * data.at( last );
+	return statistics;
+}  // end range
@@ -0,0 +1,46 @@
+#ifndef SIGNALSTATISTICS_H
+#define SIGNALSTATISTICS_H
+
+#include <QVector>
+
+
+// statistics of a signal over a range of data points
+struct SignalRangeStatistics
+{
+	int count;  // of data points that are not missing
+	double mean;
+	double rms;
+	double standardDeviation;
+	double area;  // trapezoidal, w/ one unit of time per data point
+};
+
+
+// prefix sums and prefix sums of squares of a signal, which answer the statistics over any
+// range of data points in constant time
+// the sums are taken relative to the mean of the signal and accumulated w/ Kahan compensation,
+// so that the difference of two prefix sums keeps its precision even far into long signals
+// missing (NaN) data points are left out of the statistics
+class SignalStatistics
+{
+public:
+	SignalStatistics();
+
+	void build( const QVector<float> &data );
+
+	// returns the statistics of data over [first, last]
+	SignalRangeStatistics range( const QVector<float> &data, int first, int last ) const;
+
+private:
+	double m_offset;
+
+	// m_sums[ ii ] is the sum of the 1st ii data points minus the offset, and m_squares the sum
+	// of their squares
+	QVector<double> m_sums;
+	QVector<double> m_squares;
+
+	// m_counts[ ii ] is the number of the 1st ii data points that are not missing, it is left
+	// empty when the signal has no gaps
+	QVector<qint32> m_counts;
+};
+
+#endif // SIGNALSTATISTICS_H
@@ -0,0 +1,181 @@
+#include "signalstore.h"
+#include "chartlayout.h"
+#include "signalmemory.h"
+
+#include <limits>
+
+
+SignalSnapshot::SignalSnapshot()
+	: version( 0 ),
+	  generation( 0 ),
+	  numDataPoints( 0 ),
+	  tickSize( 1000 ),
+	  numTicks( 0 ),
+	  xTickStep( 0.0f ),
+	  xStep( 0.0f )
+{
+
+}
+
+float SignalSnapshot::value( int signal, int time ) const
+{
+	const QVector<float> &data = vectorSignals.at( signal );
+	time -= timeOffsets.at( signal );
+	if ( time < 0 || time >= data.size() )
+		return std::numeric_limits<float>::quiet_NaN();
+	return data.at( time );
+}
+
+int SignalSnapshot::firstTime() const
+{
+	int time = 0;
+	for ( int offset : timeOffsets )
+		time = qMin( time, offset );
+	return time;
+}
+
+int SignalSnapshot::lastTime() const
+{
+	int time = 0;
+	for ( int offset : timeOffsets )
+		time = qMax( time, offset );
+	return time + numDataPoints - 1;
+}
+
+
+SignalStore::SignalStore( QObject *parent )  // def NULL
+	: QObject( parent ),
+	  m_eventThreshold( 0.0f ),
+	  m_memoryBytes( 0 ),
+	  m_snapshot( std::make_shared< SignalSnapshot >() )
+{
+
+}
+
+SignalStore::~SignalStore()
+{
+	SignalMemory::release( m_memoryBytes );
+}
+
+SignalSnapshotPtr SignalStore::snapshot() const
+{
+	return std::atomic_load( &m_snapshot );
+}
+
+bool SignalStore::addSignals( QVector< QVector<float> > &columns,
+							  const QVector< SignalSummary > &summaries,
+							  QString &sError )
+{
+	Q_ASSERT( columns.count() == summaries.count() );
+	if ( columns.isEmpty() )
+		return true;
+
+	QMutexLocker locker( &m_writeMutex );
+
+	// make sure the number of data points in all signals is consistent
+	// all the columns of a file have the same number of data points
+	SignalSnapshotPtr current = m_snapshot;
+	int dataPoints = columns.first().size();
+	if ( current->numDataPoints &&
+		 dataPoints != current->numDataPoints )
+	{
+		sError = "Number of data points is not the same as that of previously loaded files";
+		return false;
+	}
+
+	// the signals are drawn in the colors of the layout, so there can't be more than those
+	if ( current->signalCount() + columns.count() > ChartLayout::s_maxSignals )
+	{
+		sError = "Too many signals for the number of signal colors";
+		return false;
+	}
+
+	qint64 bytes = SignalMemory::signalBytes( dataPoints ) * columns.count();
+	if ( !SignalMemory::reserve( bytes ) )
+	{
+		sError = QString( "Not enough memory within the budget of %1 MB for the signals" )
+				 .arg( SignalMemory::budget() >> 20 );
+		return false;
+	}
+	m_memoryBytes += bytes;
+
+	// the next version shares the data of the current one
+	std::shared_ptr< SignalSnapshot > next = std::make_shared< SignalSnapshot >( *current );
+	next->version = current->version + 1;
+	if ( !next->numDataPoints )
+	{
+		// these are the 1st signals so set the chart parameters
+		next->numDataPoints = dataPoints;
+		ChartLayout::setTicks( dataPoints, next->tickSize, next->numTicks,
+							   next->xTickStep, next->xStep );
+	}
+
+	for ( int ii=0; ii<columns.count(); ii++ )
+	{
+		QVector<float> vectorEmpty;
+		next->vectorSignals.push_back( vectorEmpty );
+		next->vectorSignals.last().swap( columns[ ii ] );
+		next->vectorSummaries.push_back( summaries.at( ii ) );
+
+		SignalStatistics statistics;
+		statistics.build( next->vectorSignals.last() );
+		next->vectorStatistics.push_back( statistics );
+
+		SignalEvents events;
+		events.build( next->vectorSignals.last(), m_eventThreshold );
+		next->vectorEvents.push_back( events );
+		next->timeOffsets.push_back( 0 );
+	}
+
+	publish( next, locker );
+	return true;
+}  // end addSignals
+
+void SignalStore::clear()
+{
+	QMutexLocker locker( &m_writeMutex );
+
+	SignalMemory::release( m_memoryBytes );
+	m_memoryBytes = 0;
+
+	std::shared_ptr< SignalSnapshot > next = std::make_shared< SignalSnapshot >();
+	next->version = m_snapshot->version + 1;
+	next->generation = m_snapshot->generation + 1;
+	publish( next, locker );
+}
+
+void SignalStore::setEventThreshold( float threshold )
+{
+	QMutexLocker locker( &m_writeMutex );
+
+	m_eventThreshold = threshold;
+	std::shared_ptr< SignalSnapshot > next = std::make_shared< SignalSnapshot >( *m_snapshot );
+	next->version = m_snapshot->version + 1;
+	for ( int ii=0; ii<next->signalCount(); ii++ )
+		next->vectorEvents[ ii ].setThreshold( next->vectorSignals.at( ii ), threshold );
+	publish( next, locker );
+}
+
+void SignalStore::setTimeOffset( int signal, int offset )
+{
+	QMutexLocker locker( &m_writeMutex );
+
+	Q_ASSERT( signal >= 0 && signal < m_snapshot->signalCount() );
+	if ( m_snapshot->timeOffsets.at( signal ) == offset )
+		return;
+
+	// only the offsets are copied, the data is shared
+	std::shared_ptr< SignalSnapshot > next = std::make_shared< SignalSnapshot >( *m_snapshot );
+	next->version = m_snapshot->version + 1;
+	next->timeOffsets[ signal ] = offset;
+	publish( next, locker );
+}
+
+// must be called w/ the write mutex locked by locker, which is unlocked before the signal is
+// emitted so that the slots connected directly to it may write to the store in turn
+void SignalStore::publish( const std::shared_ptr< SignalSnapshot > &snapshot, QMutexLocker &locker )
+{
+	std::atomic_store( &m_snapshot, SignalSnapshotPtr( snapshot ) );
+	locker.unlock();
+	emit qtsignalSnapshotChanged();
+}
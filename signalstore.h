@@ -0,0 +1,116 @@
+#ifndef SIGNALSTORE_H
+#define SIGNALSTORE_H
+
+#include <QObject>
+#include <QVector>
+#include <QString>
+#include <QMutex>
+#include <QMutexLocker>
+
+#include <memory>
+
+#include "signalsummary.h"
+#include "signalstatistics.h"
+#include "signalevents.h"
+
+
+// one immutable version of the loaded signals and the chart layout that goes w/ them
+// a snapshot never changes once published, so any thread may read it w/o locking for as long
+// as it holds on to it
+struct SignalSnapshot
+{
+	SignalSnapshot();
+
+	int signalCount() const { return vectorSignals.count(); }
+	float scale( int signal ) const { return vectorSummaries.at( signal ).scale(); }
+
+	// returns the value of the signal shown at the given time, that is w/ its time offset taken
+	// into account, or NaN if the signal has no data point there
+	float value( int signal, int time ) const;
+
+	// returns the range of times at which any signal has a data point shown, which the time
+	// offsets extend beyond [0, numDataPoints - 1]
+	int firstTime() const;
+	int lastTime() const;
+
+	quint64 version;
+
+	// changes when the signals are replaced, as opposed to added to, so that views
+	// know when what they derived from the data points so far is no longer valid
+	quint64 generation;
+
+	// signal data, the vectors are implicitly shared between versions
+	QVector< QVector<float> > vectorSignals;
+	QVector< SignalSummary > vectorSummaries;
+	QVector< SignalStatistics > vectorStatistics;
+	QVector< SignalEvents > vectorEvents;
+	int numDataPoints;
+
+	// number of data points every signal is shown shifted to the right by, data point ii of a
+	// signal being shown at time ii + its offset, so that signals can be lined up w/o copying them
+	QVector< int > timeOffsets;
+
+	// X axis layout, set by the 1st signals added
+	int tickSize;
+	int numTicks;
+	float xTickStep;
+	float xStep;
+};
+
+typedef std::shared_ptr< const SignalSnapshot > SignalSnapshotPtr;
+
+
+// holds the signals independently of any widget
+// readers, the GUI as well as analysis threads, take a snapshot and work on it w/o locks, while
+// writers, which are serialized among themselves, build the next version and publish it
+// atomically, then emit qtsignalSnapshotChanged() once they no longer hold the write mutex, so
+// the slots connected to it may write to the store themselves
+// the memory of the signals is reserved in the budget of SignalMemory for as long as the store
+// holds them
+class SignalStore : public QObject
+{
+	Q_OBJECT
+
+public:
+	SignalStore( QObject *parent = 0 );
+	~SignalStore();
+
+	// returns the current version of the signals, never null
+	SignalSnapshotPtr snapshot() const;
+
+	// adds the given columns as new signals, taking over their data, and builds their
+	// statistics and event indexes
+	// returns false and sets sError if their number of data points is not that of the signals
+	// already in the store, there would be more signals than colors to draw them in, or they
+	// don't fit in the memory budget
+	bool addSignals( QVector< QVector<float> > &columns,
+					 const QVector< SignalSummary > &summaries,
+					 QString &sError );
+
+	// removes all the signals
+	void clear();
+
+	// reindexes the threshold crossings of every signal at the given level
+	void setEventThreshold( float threshold );
+	float eventThreshold() const { return m_eventThreshold; }
+
+	// shows the given signal shifted to the right by offset data points, left if negative
+	void setTimeOffset( int signal, int offset );
+
+signals:
+	void qtsignalSnapshotChanged();
+
+private:
+	void publish( const std::shared_ptr< SignalSnapshot > &snapshot, QMutexLocker &locker );
+
+	float m_eventThreshold;
+
+	// reserved in the memory budget for the signals
+	qint64 m_memoryBytes;
+
+	// serializes the writers, readers never take it
+	QMutex m_writeMutex;
+	SignalSnapshotPtr m_snapshot;
+};
+
+#endif // SIGNALSTORE_H
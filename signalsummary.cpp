@@ -0,0 +1,160 @@
+#include "signalsummary.h"
+
+#include <QThread>
+#include <QtConcurrent>
+
+
+namespace
+{
+
+// orders NaN after every number so missing data points never win a comparison
+inline bool isLess( float a, float b )
+{
+	return a < b || b != b;
+}
+
+}  // end anonymous namespace
+
+
+SignalSummary::SignalSummary()
+	: m_smallestY( 1.0f ),
+	  m_largestY( -1.0f ),
+	  m_scale( 1.0f )
+{
+
+}
+
+void SignalSummary::build( const QVector<float> &data, float smallestY, float largestY )
+{
+	m_smallestY = smallestY;
+	m_largestY = largestY;
+	m_minima.clear();
+	m_maxima.clear();
+	m_minIndex.clear();
+	m_maxIndex.clear();
+
+	int count = data.size();
+	if ( !count )
+		return;
+
+	// level 0 reads every sample so its blocks are split among the threads
+	int numBlocks = ( count + s_baseBlockSize - 1 ) / s_baseBlockSize;
+	QVector<float> minima( numBlocks ),
+			maxima( numBlocks );
+	QVector<qint32> minIndex( numBlocks ),
+			maxIndex( numBlocks );
+
+	int numTasks = qMin( numBlocks, QThread::idealThreadCount() * 4 );
+	QVector<int> tasks( numTasks );
+	for ( int ii=0; ii<numTasks; ii++ )
+		tasks[ ii ] = ii;
+
+	const float *pData = data.constData();
+	QtConcurrent::blockingMap( tasks, [&]( int task )
+	{
+		int firstBlock = (int) ( (qint64) numBlocks * task / numTasks ),
+				lastBlock = (int) ( (qint64) numBlocks * ( task + 1 ) / numTasks );
+		for ( int block=firstBlock; block<lastBlock; block++ )
+		{
+			int first = block * s_baseBlockSize,
+					last = qMin( first + s_baseBlockSize, count );
+			int minTime = first,
+					maxTime = first;
+			for ( int jj=first+1; jj<last; jj++ )
+			{
+				if ( isLess( pData[ jj ], pData[ minTime ] ) )
+					minTime = jj;
+				if ( isLess( -pData[ jj ], -pData[ maxTime ] ) )
+					maxTime = jj;
+			}
+			minIndex[ block ] = minTime;
+			maxIndex[ block ] = maxTime;
+			minima[ block ] = pData[ minTime ];
+			maxima[ block ] = pData[ maxTime ];
+		}
+	} );
+
+	m_minima.push_back( minima );
+	m_maxima.push_back( maxima );
+	m_minIndex.push_back( minIndex );
+	m_maxIndex.push_back( maxIndex );
+
+	// every level above merges pairs of blocks of the level below
+	while ( numBlocks > 1 )
+	{
+		const QVector<float> &lowerMinima = m_minima.last(),
+				&lowerMaxima = m_maxima.last();
+		const QVector<qint32> &lowerMinIndex = m_minIndex.last(),
+				&lowerMaxIndex = m_maxIndex.last();
+
+		int lowerBlocks = numBlocks;
+		numBlocks = ( lowerBlocks + 1 ) / 2;
+		minima.resize( numBlocks );
+		maxima.resize( numBlocks );
+		minIndex.resize( numBlocks );
+		maxIndex.resize( numBlocks );
+		for ( int block=0; block<numBlocks; block++ )
+		{
+			int left = 2 * block,
+					right = qMin( left + 1, lowerBlocks - 1 );
+			int minBlock = isLess( lowerMinima.at( right ), lowerMinima.at( left ) ) ? right : left,
+					maxBlock = isLess( -lowerMaxima.at( right ), -lowerMaxima.at( left ) ) ? right : left;
+			minima[ block ] = lowerMinima.at( minBlock );
+			maxima[ block ] = lowerMaxima.at( maxBlock );
+			minIndex[ block ] = lowerMinIndex.at( minBlock );
+			maxIndex[ block ] = lowerMaxIndex.at( maxBlock );
+		}
+
+		m_minima.push_back( minima );
+		m_maxima.push_back( maxima );
+		m_minIndex.push_back( minIndex );
+		m_maxIndex.push_back( maxIndex );
+	}  // end while more than one block
+}  // end build
+
+int SignalSummary::levelForSamples( int samplesPerBlock ) const
+{
+	int level = -1;
+	while ( level + 1 < levels() &&
+			blockSize( level + 1 ) <= samplesPerBlock )
+		level++;
+	return level;
+}
+
+int SignalSummary::findExtremum( const QVector<float> &data, int first, int last, bool bMaximum ) const
+{
+	Q_ASSERT( first >= 0 && last < data.size() );
+
+	int best = first;
+	const float *pData = data.constData();
+	auto consider = [&]( int time )
+	{
+		if ( bMaximum ? isLess( -pData[ time ], -pData[ best ] ) : isLess( pData[ time ], pData[ best ] ) )
+			best = time;
+	};
+
+	// samples before the 1st whole block
+	int time = first;
+	while ( time <= last && time % s_baseBlockSize )
+		consider( time++ );
+
+	// whole blocks, taking the coarsest level their alignment allows
+	while ( levels() && time + s_baseBlockSize - 1 <= last )
+	{
+		int level = 0;
+		while ( level + 1 < levels() &&
+				time % blockSize( level + 1 ) == 0 &&
+				time + blockSize( level + 1 ) - 1 <= last )
+			level++;
+
+		int block = time / blockSize( level );
+		consider( bMaximum ? m_maxIndex.at( level ).at( block ) : m_minIndex.at( level ).at( block ) );
+		time += blockSize( level );
+	}
+
+	// samples after the last whole block
+	while ( time <= last )
+		consider( time++ );
+
+	return best;
+}  // end findExtremum
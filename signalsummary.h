@@ -0,0 +1,59 @@
+#ifndef SIGNALSUMMARY_H
+#define SIGNALSUMMARY_H
+
+#include <QVector>
+
+
+// derived data of a signal that is expensive to recompute: its range, its display scale, a
+// min/max decimation pyramid and an index of where the extrema of the pyramid blocks are
+// level 0 of the pyramid covers blocks of s_baseBlockSize samples, and each level above
+// merges pairs of blocks of the level below until a single block covers the whole signal
+// missing (NaN) data points are ignored, a block w/ nothing but missing data points is NaN
+class SignalSummary
+{
+public:
+	static const int s_baseBlockSize = 64;
+
+	SignalSummary();
+
+	// builds the pyramid and the extremum index of the given signal
+	void build( const QVector<float> &data, float smallestY, float largestY );
+
+	float smallestY() const { return m_smallestY; }
+	float largestY() const { return m_largestY; }
+
+	// scale factor that fits the signal into the chart
+	float scale() const { return m_scale; }
+	void setScale( float scale ) { m_scale = scale; }
+
+	int levels() const { return m_minima.count(); }
+	int blockSize( int level ) const { return s_baseBlockSize << level; }
+
+	// returns the coarsest level whose blocks hold no more than the given number of samples,
+	// or -1 if even level 0 blocks hold more
+	int levelForSamples( int samplesPerBlock ) const;
+
+	const QVector<float> &minima( int level ) const { return m_minima.at( level ); }
+	const QVector<float> &maxima( int level ) const { return m_maxima.at( level ); }
+
+	// returns the index of the largest, or the smallest, sample of data in [first, last]
+	// visits at most two base blocks of samples plus two blocks per pyramid level
+	int findExtremum( const QVector<float> &data, int first, int last, bool bMaximum ) const;
+
+private:
+	friend class SignalCache;
+
+	float m_smallestY;
+	float m_largestY;
+	float m_scale;
+
+	// pyramid, one vector of block minima and maxima per level
+	QVector< QVector<float> > m_minima;
+	QVector< QVector<float> > m_maxima;
+
+	// extremum index, the sample index of the minimum and maximum of each pyramid block
+	QVector< QVector<qint32> > m_minIndex;
+	QVector< QVector<qint32> > m_maxIndex;
+};
+
+#endif // SIGNALSUMMARY_H
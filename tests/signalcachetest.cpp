@@ -0,0 +1,191 @@
+#include "../signalcache.h"
+#include "../signalfilereader.h"
+
+#include <QCoreApplication>
+#include <QTemporaryDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+
+#include <cstdio>
+
+#include "testcheck.h"
+
+
+namespace
+{
+
+// writes a signal file of numLines lines of 2 columns, big enough for the cache to hash samples
+// of it between its start and end
+bool writeSource( const QString &filename, int numLines )
+{
+	QFile file( filename );
+	if ( !file.open( QIODevice::WriteOnly ) )
+		return false;
+
+	QByteArray text;
+	char line[ 64 ];
+	for ( int ii=0; ii<numLines; ii++ )
+	{
+		int length = snprintf( line, sizeof( line ), "%d,%d.25\n", ii % 1000, ii % 777 );
+		text.append( line, length );
+	}
+	return file.write( text ) == text.size();
+}
+
+// overwrites the 1st digit from offset on w/ another one and puts the modification time back,
+// so that only the sampled hash of the file tells it has changed
+bool overwriteDigit( const QString &filename, qint64 offset )
+{
+	QDateTime modified = QFileInfo( filename ).lastModified();
+	QFile file( filename );
+	if ( !file.open( QIODevice::ReadWrite ) ||
+		 !file.seek( offset ) )
+		return false;
+	QByteArray bytes = file.read( 16 );
+	int digit = 0;
+	while ( digit < bytes.size() && ( bytes.at( digit ) < '0' || bytes.at( digit ) > '9' ) )
+		digit++;
+	if ( digit == bytes.size() )
+		return false;
+
+	QByteArray byte( 1, bytes.at( digit ) == '7' ? '8' : '7' );
+	return file.seek( offset + digit ) &&
+		   file.write( byte ) == 1 &&
+		   file.setFileTime( modified, QFileDevice::FileModificationTime );
+}
+
+bool setModified( const QString &filename, const QDateTime &modified )
+{
+	QFile file( filename );
+	return file.open( QIODevice::ReadWrite ) &&
+		   file.setFileTime( modified, QFileDevice::FileModificationTime );
+}
+
+// reads the source and builds the summaries, the way the loader does before saving the cache
+bool readSource( const QString &filename,
+				 QVector< QVector<float> > &columns,
+				 QVector< SignalSummary > &summaries )
+{
+	SignalFileReader reader;
+	QVector<float> smallestY,
+			largestY;
+	QString sError;
+	if ( !reader.read( filename, columns, smallestY, largestY, sError ) )
+		return false;
+
+	summaries.resize( columns.count() );
+	for ( int ii=0; ii<columns.count(); ii++ )
+	{
+		summaries[ ii ].build( columns.at( ii ), smallestY.at( ii ), largestY.at( ii ) );
+		summaries[ ii ].setScale( 0.5f + ii );
+	}
+	return true;
+}
+
+// returns true if the cache of filename loads, w/ the given columns and summaries
+bool loadsFresh( const QString &filename,
+				 const QVector< QVector<float> > &columns,
+				 const QVector< SignalSummary > &summaries )
+{
+	QVector< QVector<float> > cachedColumns;
+	QVector< SignalSummary > cachedSummaries;
+	QString sError;
+	if ( !SignalCache::load( filename, '\0', false, 0, cachedColumns, cachedSummaries, sError ) )
+		return false;
+
+	bool bSame = cachedColumns == columns && cachedSummaries.count() == summaries.count();
+	for ( int ii=0; bSame && ii<summaries.count(); ii++ )
+	{
+		const SignalSummary &cached = cachedSummaries.at( ii ),
+				&summary = summaries.at( ii );
+		bSame = cached.smallestY() == summary.smallestY() &&
+				cached.largestY() == summary.largestY() &&
+				cached.scale() == summary.scale() &&
+				cached.levels() == summary.levels();
+		for ( int level=0; bSame && level<summary.levels(); level++ )
+			bSame = cached.minima( level ) == summary.minima( level ) &&
+					cached.maxima( level ) == summary.maxima( level );
+	}
+	return bSame;
+}
+
+// a cache is used while its file is unchanged, and is stale, and rebuilt by the next save,
+// once the file changes size, modification time or content
+void testFreshness()
+{
+	QTemporaryDir dir;
+	CHECK( dir.isValid() );
+	QString filename = dir.filePath( "signal.csv" );
+	CHECK( writeSource( filename, 100000 ) );
+
+	QVector< QVector<float> > columns;
+	QVector< SignalSummary > summaries;
+	QString sError;
+	CHECK( readSource( filename, columns, summaries ) );
+	CHECK( columns.count() == 2 );
+
+	// no cache yet
+	QVector< QVector<float> > cachedColumns;
+	QVector< SignalSummary > cachedSummaries;
+	CHECK( !SignalCache::load( filename, '\0', false, 0, cachedColumns, cachedSummaries, sError ) );
+	CHECK( sError.isEmpty() );
+
+	CHECK( SignalCache::save( filename, '\0', false, columns, summaries ) );
+	CHECK( loadsFresh( filename, columns, summaries ) );
+
+	// parsed another way
+	CHECK( !SignalCache::load( filename, ',', false, 0, cachedColumns, cachedSummaries, sError ) );
+	CHECK( !SignalCache::load( filename, '\0', true, 0, cachedColumns, cachedSummaries, sError ) );
+	CHECK( sError.isEmpty() );
+
+	// up to date but w/ the wrong number of data points
+	CHECK( !SignalCache::load( filename, '\0', false, 5, cachedColumns, cachedSummaries, sError ) );
+	CHECK( !sError.isEmpty() );
+
+	// size
+	CHECK( writeSource( filename, 100001 ) );
+	CHECK( !loadsFresh( filename, columns, summaries ) );
+	CHECK( readSource( filename, columns, summaries ) );
+	CHECK( SignalCache::save( filename, '\0', false, columns, summaries ) );
+	CHECK( loadsFresh( filename, columns, summaries ) );
+
+	// modification time
+	QDateTime modified = QFileInfo( filename ).lastModified();
+	CHECK( setModified( filename, modified.addMSecs( 10000 ) ) );
+	CHECK( !loadsFresh( filename, columns, summaries ) );
+	CHECK( SignalCache::save( filename, '\0', false, columns, summaries ) );
+	CHECK( loadsFresh( filename, columns, summaries ) );
+
+	// content at the start of the file, and in one of the samples between its start and end
+	qint64 size = QFileInfo( filename ).size();
+	qint64 offsets[] = { 100, size * 5 / 17 + 10 };
+	for ( qint64 offset : offsets )
+	{
+		CHECK( overwriteDigit( filename, offset ) );
+		CHECK( QFileInfo( filename ).size() == size );
+		CHECK( !loadsFresh( filename, columns, summaries ) );
+		CHECK( readSource( filename, columns, summaries ) );
+		CHECK( SignalCache::save( filename, '\0', false, columns, summaries ) );
+		CHECK( loadsFresh( filename, columns, summaries ) );
+	}
+
+	CHECK( QFile::remove( SignalCache::cacheFilename( filename ) ) );
+	CHECK( !loadsFresh( filename, columns, summaries ) );
+}
+
+}  // end anonymous namespace
+
+
+// exercises SignalCache on files in a temporary directory
+// returns the number of failed checks
+int main( int argc, char *argv[] )
+{
+	QCoreApplication app( argc, argv );
+
+	testFreshness();
+
+	if ( s_failures )
+		fprintf( stderr, "%d checks failed\n", s_failures );
+	return s_failures;
+}  // end main
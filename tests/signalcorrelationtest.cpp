@@ -0,0 +1,236 @@
+#include "../signalcorrelation.h"
+#include "../signalmemory.h"
+
+#include <QCoreApplication>
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+
+#include "testcheck.h"
+
+
+namespace
+{
+
+const float s_nan = std::numeric_limits<float>::quiet_NaN();
+
+// returns the mean of the data points that are not missing, and their energy about it
+void directMoments( const QVector<float> &data, double &mean, double &energy )
+{
+	double sum = 0.0;
+	int count = 0;
+	for ( float value : data )
+	{
+		if ( value == value )
+		{
+			sum += value;
+			count++;
+		}
+	}
+	mean = count ? sum / count : 0.0;
+
+	energy = 0.0;
+	for ( float value : data )
+	{
+		if ( value == value )
+			energy += ( value - mean ) * ( value - mean );
+	}
+}
+
+// sum( first[ t + lag ] * second[ t ] ) of both signals relative to their mean, w/ the missing
+// data points adding nothing
+double directCorrelation( const QVector<float> &first, double firstMean,
+						  const QVector<float> &second, double secondMean, int lag )
+{
+	double sum = 0.0;
+	for ( int ii=qMax( 0, -lag ); ii<second.size() && ii+lag<first.size(); ii++ )
+	{
+		float a = first.at( ii + lag ),
+				b = second.at( ii );
+		if ( a == a && b == b )
+			sum += ( a - firstMean ) * ( b - secondMean );
+	}
+	return sum;
+}
+
+// checks the best lag of first and second against the correlations at every lag summed
+// directly, the FFTs being done in float, the lag found need only be as good as the best one
+// to their precision
+// returns the lag found, or INT_MIN if it is not the best one
+int checkBestLag( const QVector<float> &first, const QVector<float> &second, int maxLag = -1 )
+{
+	SignalLag result = SignalCorrelation::bestLag( first, second, maxLag );
+	int count = qMax( first.size(), second.size() );
+	if ( maxLag < 0 || maxLag > count - 1 )
+		maxLag = count - 1;
+
+	double firstMean,
+			firstEnergy,
+			secondMean,
+			secondEnergy;
+	directMoments( first, firstMean, firstEnergy );
+	directMoments( second, secondMean, secondEnergy );
+	double scale = sqrt( firstEnergy * secondEnergy );
+
+	int bestLag = 0;
+	double bestCorrelation = 0.0;
+	for ( int lag=-maxLag; lag<=maxLag; lag++ )
+	{
+		double correlation = directCorrelation( first, firstMean, second, secondMean, lag );
+		if ( fabs( correlation ) > fabs( bestCorrelation ) )
+		{
+			bestCorrelation = correlation;
+			bestLag = lag;
+		}
+	}
+
+	double correlation = result.lag >= -maxLag && result.lag <= maxLag
+			? directCorrelation( first, firstMean, second, secondMean, result.lag ) : 0.0;
+	bool bOk = result.bValid &&
+			   fabs( correlation ) >= fabs( bestCorrelation ) - 1e-4 * scale &&
+			   fabs( result.coefficient - correlation / scale ) < 1e-3;
+	if ( !bOk )
+	{
+		fprintf( stderr, "  %d and %d data points up to lag %d: lag %d coefficient %g, best lag %d coefficient %g\n",
+				 first.size(), second.size(), maxLag, result.lag, result.coefficient,
+				 bestLag, bestCorrelation / scale );
+		return std::numeric_limits<int>::min();
+	}
+	return result.lag;
+}
+
+QVector<float> noise( int count )
+{
+	QVector<float> data( count );
+	for ( int ii=0; ii<count; ii++ )
+		data[ ii ] = ( rand() % 2001 - 1000 ) / 100.0f;
+	return data;
+}
+
+// returns data delayed by delay data points, negative to advance it, the data points shifted in
+// from outside of it being noise
+QVector<float> delayed( const QVector<float> &data, int delay, float gain )
+{
+	QVector<float> shifted = noise( data.size() );
+	for ( int ii=0; ii<data.size(); ii++ )
+	{
+		if ( ii - delay >= 0 && ii - delay < data.size() )
+			shifted[ ii ] = gain * data.at( ii - delay ) + ( rand() % 101 - 50 ) / 100.0f;
+	}
+	return shifted;
+}
+
+// signals of lengths that are not powers of 2, one a delayed, advanced or inverted copy of
+// the other, w/ gaps in them
+void testSmall()
+{
+	srand( 1 );
+	int lengths[] = { 5, 37, 300, 1000, 1023, 1025 };
+	for ( int length : lengths )
+	{
+		int delays[] = { 0, 1, -1, length / 3, -length / 4 };
+		for ( int delay : delays )
+		{
+			for ( float gain : { 1.0f, -0.5f } )
+			{
+				QVector<float> second = noise( length ),
+						first = delayed( second, delay, gain );
+				int lag = checkBestLag( first, second );
+				// the copies of the shortest signals may not line up best where they were shifted
+				if ( length > 5 )
+				{
+					CHECK( lag == delay );
+					CHECK( ( SignalCorrelation::bestLag( first, second ).coefficient < 0.0f ) == ( gain < 0.0f ) );
+				}
+				else
+					CHECK( lag != std::numeric_limits<int>::min() );
+
+				// gaps, at the ends and in the middle
+				first[ 0 ] = s_nan;
+				second[ length - 1 ] = s_nan;
+				for ( int ii=length/2; ii<length/2+length/10; ii++ )
+					first[ ii ] = s_nan;
+				CHECK( checkBestLag( first, second ) != std::numeric_limits<int>::min() );
+
+				// a lag limited short of the delay
+				CHECK( checkBestLag( first, second, qAbs( delay ) / 2 ) != std::numeric_limits<int>::min() );
+			}
+		}
+	}
+
+	// signals of different lengths
+	QVector<float> second = noise( 700 ),
+			first = delayed( second, 55, 1.0f );
+	first.resize( 400 );
+	CHECK( checkBestLag( first, second ) == 55 );
+	CHECK( checkBestLag( second, first ) == -55 );
+	CHECK( SignalMemory::used() == 0 );
+}
+
+// signals long enough for FFTs of more than a block, whose outer stages are done in pairs, and
+// a single one after them
+void testLarge()
+{
+	srand( 2 );
+	struct Case
+	{
+		int length;
+		int delay;
+		int maxLag;
+	};
+	Case cases[] =
+	{
+		{ 20000, -7321, -1 },     // FFT of 2^16, a pair of stages beyond the block
+		{ 70001, 1234, 2000 },    // 2^17, a pair and a single stage
+		{ 70001, -1999, 2000 }
+	};
+	for ( const Case &test : cases )
+	{
+		QVector<float> second = noise( test.length ),
+				first = delayed( second, test.delay, -1.0f );
+		for ( int ii=100; ii<test.length; ii+=5000 )
+			first[ ii ] = second[ ii + 1 ] = s_nan;
+		CHECK( checkBestLag( first, second, test.maxLag ) == test.delay );
+	}
+	CHECK( SignalMemory::used() == 0 );
+}
+
+// empty and constant signals have no lag
+void testInvalid()
+{
+	QVector<float> data = noise( 100 ),
+			constant( 100, 3.0f ),
+			missing( 100, s_nan );
+	CHECK( !SignalCorrelation::bestLag( data, QVector<float>() ).bValid );
+	CHECK( !SignalCorrelation::bestLag( QVector<float>(), data ).bValid );
+	CHECK( !SignalCorrelation::bestLag( data, constant ).bValid );
+	CHECK( !SignalCorrelation::bestLag( missing, data ).bValid );
+
+	// nor do signals whose FFT is over the budget
+	qint64 budget = SignalMemory::budget();
+	SignalMemory::setBudget( 1000 );
+	CHECK( !SignalCorrelation::bestLag( data, data ).bValid );
+	SignalMemory::setBudget( budget );
+	CHECK( SignalCorrelation::bestLag( data, data ).bValid );
+	CHECK( SignalMemory::used() == 0 );
+}
+
+}  // end anonymous namespace
+
+
+// exercises SignalCorrelation against correlations summed directly
+// returns the number of failed checks
+int main( int argc, char *argv[] )
+{
+	QCoreApplication app( argc, argv );
+
+	testSmall();
+	testLarge();
+	testInvalid();
+
+	if ( s_failures )
+		fprintf( stderr, "%d checks failed\n", s_failures );
+	return s_failures;
+}  // end main
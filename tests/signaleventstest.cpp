@@ -0,0 +1,252 @@
+#include "../signalevents.h"
+
+#include <QCoreApplication>
+#include <QThread>
+
+#include <cmath>
+#include <cstdio>
+#include <limits>
+
+#include "testcheck.h"
+
+
+namespace
+{
+
+const float s_nan = std::numeric_limits<float>::quiet_NaN();
+
+// the events of data found one data point at a time, as documented by SignalEvents
+// the extrema are found from the runs of equal data points, a run being an extremum if it is
+// above or below the runs on both sides of it, and NaN never being equal to or beyond anything
+void directEvents( const QVector<float> &data, float threshold,
+				   QVector<int> &rising, QVector<int> &falling, QVector<int> &extrema, QVector<int> &gaps )
+{
+	rising.clear();
+	falling.clear();
+	extrema.clear();
+	gaps.clear();
+	for ( int ii=0; ii<data.size(); ii++ )
+	{
+		float value = data.at( ii );
+		if ( value != value && ( ii == 0 || data.at( ii - 1 ) == data.at( ii - 1 ) ) )
+			gaps.push_back( ii );
+		if ( ii == 0 )
+			continue;
+		if ( data.at( ii - 1 ) < threshold && value >= threshold )
+			rising.push_back( ii );
+		if ( data.at( ii - 1 ) >= threshold && value < threshold )
+			falling.push_back( ii );
+	}
+
+	QVector<int> runs;
+	for ( int ii=0; ii<data.size(); ii++ )
+	{
+		if ( ii == 0 || data.at( ii ) != data.at( ii - 1 ) )
+			runs.push_back( ii );
+	}
+	for ( int run=1; run<runs.size() - 1; run++ )
+	{
+		float value = data.at( runs.at( run ) ),
+				previous = data.at( runs.at( run - 1 ) ),
+				next = data.at( runs.at( run + 1 ) );
+		if ( ( value > previous && value > next ) || ( value < previous && value < next ) )
+			extrema.push_back( runs.at( run ) );
+	}
+}  // end directEvents
+
+// returns the events of the given type, found by stepping forward, or backward, through them
+QVector<int> stepThrough( const SignalEvents &events, SignalEvents::Type type, int numDataPoints, bool bForward )
+{
+	QVector<int> found;
+	int time = bForward ? -1 : numDataPoints;
+	while ( ( time = events.find( type, time, bForward ) ) >= 0 )
+	{
+		if ( bForward )
+			found.push_back( time );
+		else
+			found.prepend( time );
+	}
+	return found;
+}
+
+bool checkEvents( const SignalEvents &events, SignalEvents::Type type, int numDataPoints,
+				  const QVector<int> &expected, const char *name )
+{
+	bool bOk = events.count( type ) == expected.size() &&
+			   stepThrough( events, type, numDataPoints, true ) == expected &&
+			   stepThrough( events, type, numDataPoints, false ) == expected;
+	if ( !bOk )
+		fprintf( stderr, "  %s: %d events, %d expected\n", name, events.count( type ), expected.size() );
+	return bOk;
+}
+
+// checks every type of event of data against those found directly
+bool checkAgainstDirect( const SignalEvents &events, const QVector<float> &data )
+{
+	QVector<int> rising,
+			falling,
+			extrema,
+			gaps;
+	directEvents( data, events.threshold(), rising, falling, extrema, gaps );
+
+	QVector<int> crossings = rising + falling;
+	std::sort( crossings.begin(), crossings.end() );
+	return checkEvents( events, SignalEvents::RisingCrossing, data.size(), rising, "rising" ) &&
+		   checkEvents( events, SignalEvents::FallingCrossing, data.size(), falling, "falling" ) &&
+		   checkEvents( events, SignalEvents::Crossing, data.size(), crossings, "crossings" ) &&
+		   checkEvents( events, SignalEvents::Extremum, data.size(), extrema, "extrema" ) &&
+		   checkEvents( events, SignalEvents::Gap, data.size(), gaps, "gaps" );
+}
+
+// NaN is neither below nor above the threshold, nor beyond its neighbours, so the data points
+// next to a gap are never crossings or extrema
+void testNaNNeighbours()
+{
+	QVector<float> data = { 0.0f, s_nan, 2.0f, s_nan, -1.0f, 2.0f, s_nan, s_nan, 3.0f, 0.0f, s_nan };
+	SignalEvents events;
+	events.build( data, 1.0f );
+	CHECK( checkEvents( events, SignalEvents::RisingCrossing, data.size(), { 5 }, "rising" ) );
+	CHECK( checkEvents( events, SignalEvents::FallingCrossing, data.size(), { 9 }, "falling" ) );
+	CHECK( checkEvents( events, SignalEvents::Extremum, data.size(), {}, "extrema" ) );
+	CHECK( checkEvents( events, SignalEvents::Gap, data.size(), { 1, 3, 6, 10 }, "gaps" ) );
+	CHECK( checkAgainstDirect( events, data ) );
+
+	// a signal that starts w/ a gap
+	data = { s_nan, s_nan, 2.0f, 0.0f, 2.0f };
+	events.build( data, 1.0f );
+	CHECK( checkEvents( events, SignalEvents::Gap, data.size(), { 0 }, "gaps" ) );
+	CHECK( checkEvents( events, SignalEvents::Crossing, data.size(), { 3, 4 }, "crossings" ) );
+	CHECK( checkEvents( events, SignalEvents::Extremum, data.size(), { 3 }, "extrema" ) );
+}
+
+// a plateau is an extremum, indexed by its 1st data point, if the data points on both sides of
+// it are below or above it, and never if it runs into either end of the signal
+void testPlateaus()
+{
+	QVector<float> data = { 0.0f, 1.0f, 1.0f, 1.0f, 0.0f, 0.0f, 2.0f, 2.0f, 3.0f, 3.0f, 1.0f };
+	SignalEvents events;
+	events.build( data, 0.5f );
+	CHECK( checkEvents( events, SignalEvents::Extremum, data.size(), { 1, 4, 8 }, "extrema" ) );
+	CHECK( checkEvents( events, SignalEvents::RisingCrossing, data.size(), { 1, 6 }, "rising" ) );
+	CHECK( checkEvents( events, SignalEvents::FallingCrossing, data.size(), { 4 }, "falling" ) );
+	CHECK( checkAgainstDirect( events, data ) );
+
+	data = { 1.0f, 1.0f, 0.0f, 2.0f, 2.0f };
+	events.build( data, 0.5f );
+	CHECK( checkEvents( events, SignalEvents::Extremum, data.size(), { 2 }, "extrema" ) );
+
+	// a plateau that ends in a gap is not an extremum
+	data = { 0.0f, 1.0f, 1.0f, s_nan, 0.0f };
+	events.build( data, 0.5f );
+	CHECK( checkEvents( events, SignalEvents::Extremum, data.size(), {}, "extrema" ) );
+
+	data = QVector<float>( 100, 3.0f );
+	events.build( data, 3.0f );
+	for ( int type=SignalEvents::RisingCrossing; type<=SignalEvents::Gap; type++ )
+		CHECK( events.count( (SignalEvents::Type) type ) == 0 );
+}
+
+// the scans are split into chunks of the signal, so the events around the start of each chunk,
+// and the plateaus and gaps that run across them, are put there and checked against those found
+// directly
+void testChunkBoundaries()
+{
+	const int numDataPoints = 65536 * 40 + 777;
+	QVector<float> data( numDataPoints );
+	for ( int ii=0; ii<numDataPoints; ii++ )
+		data[ ii ] = (float) sin( ii * 0.0003 );
+
+	// the chunks of the scans that start at 1, those of the gaps, which start at 0, are shifted
+	// by at most a data point
+	int numChunks = qMax( 1, qMin( ( numDataPoints - 1 ) / 65536, QThread::idealThreadCount() * 4 ) );
+	for ( int chunk=1; chunk<numChunks; chunk++ )
+	{
+		int start = 1 + (int) ( (qint64) ( numDataPoints - 1 ) * chunk / numChunks );
+		switch ( chunk % 4 )
+		{
+		case 0:
+			// a spike at either side of the start
+			data[ start - 1 ] = 5.0f;
+			data[ start + 2 ] = -5.0f;
+			break;
+		case 1:
+			// a plateau across it
+			for ( int ii=start-3; ii<start+3; ii++ )
+				data[ ii ] = 4.0f;
+			break;
+		case 2:
+			// a gap across it, and one that ends right before another starts
+			for ( int ii=start-10; ii<start+10; ii++ )
+				data[ ii ] = s_nan;
+			data[ start - 40 ] = data[ start - 38 ] = data[ start - 37 ] = s_nan;
+			break;
+		case 3:
+			// a crossing at its 1st data point
+			data[ start - 1 ] = -2.0f;
+			data[ start ] = 2.0f;
+			break;
+		}
+	}
+
+	SignalEvents events;
+	events.build( data, 0.0f );
+	CHECK( checkAgainstDirect( events, data ) );
+	CHECK( events.count( SignalEvents::Gap ) > 0 && events.count( SignalEvents::Crossing ) > 0 );
+
+	events.setThreshold( data, 3.0f );
+	CHECK( checkAgainstDirect( events, data ) );
+}
+
+// find() looks strictly after, or before, the given time, and returns -1 past the last event, or
+// before the 1st one
+void testFind()
+{
+	QVector<float> data = { 0.0f, 0.0f, 2.0f, 2.0f, 2.0f, 0.0f, 0.0f, 2.0f, 2.0f };
+	SignalEvents events;
+	events.build( data, 1.0f );
+
+	CHECK( events.find( SignalEvents::RisingCrossing, -1, true ) == 2 );
+	CHECK( events.find( SignalEvents::RisingCrossing, 2, true ) == 7 );
+	CHECK( events.find( SignalEvents::RisingCrossing, 7, true ) == -1 );
+	CHECK( events.find( SignalEvents::RisingCrossing, 100, true ) == -1 );
+	CHECK( events.find( SignalEvents::RisingCrossing, 100, false ) == 7 );
+	CHECK( events.find( SignalEvents::RisingCrossing, 7, false ) == 2 );
+	CHECK( events.find( SignalEvents::RisingCrossing, 2, false ) == -1 );
+	CHECK( events.find( SignalEvents::RisingCrossing, 0, false ) == -1 );
+
+	CHECK( events.find( SignalEvents::Crossing, 2, true ) == 5 );
+	CHECK( events.find( SignalEvents::Crossing, 5, true ) == 7 );
+	CHECK( events.find( SignalEvents::Crossing, 7, false ) == 5 );
+	CHECK( events.find( SignalEvents::Crossing, 5, false ) == 2 );
+	CHECK( events.find( SignalEvents::FallingCrossing, 5, true ) == -1 );
+	CHECK( events.find( SignalEvents::FallingCrossing, 6, false ) == 5 );
+	CHECK( events.find( SignalEvents::Gap, -1, true ) == -1 );
+
+	QVector<float> empty;
+	events.build( empty, 0.0f );
+	for ( int type=SignalEvents::RisingCrossing; type<=SignalEvents::Gap; type++ )
+	{
+		CHECK( events.count( (SignalEvents::Type) type ) == 0 );
+		CHECK( events.find( (SignalEvents::Type) type, 0, true ) == -1 );
+		CHECK( events.find( (SignalEvents::Type) type, 0, false ) == -1 );
+	}
+}
+
+}  // end anonymous namespace
+
+
+// exercises SignalEvents against events found one data point at a time
+// returns the number of failed checks
+int main( int argc, char *argv[] )
+{
+	QCoreApplication app( argc, argv );
+
+	testNaNNeighbours();
+	testPlateaus();
+	testChunkBoundaries();
+	testFind();
+
+	if ( s_failures )
+		fprintf( stderr, "%d checks failed\n", s_failures );
+	return s_failures;
+}  // end main
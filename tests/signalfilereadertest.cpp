@@ -0,0 +1,375 @@
+#include "../signalfilereader.h"
+#include "../signalmemory.h"
+
+#include <QCoreApplication>
+#include <QByteArray>
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+#include <zlib.h>
+
+#include "testcheck.h"
+
+
+namespace
+{
+
+const char *s_mismatchError = "Number of data points is not the same as that of previously loaded files";
+
+bool parseText( SignalFileReader &reader,
+				const QByteArray &text,
+				QVector< QVector<float> > &columns,
+				QVector<float> &smallestY,
+				QVector<float> &largestY,
+				QString &sError )
+{
+	return reader.parse( text.constData(), text.constData() + text.size(), columns, smallestY, largestY, sError );
+}
+
+bool parseGzip( SignalFileReader &reader,
+				const QByteArray &compressed,
+				QVector< QVector<float> > &columns,
+				QVector<float> &smallestY,
+				QVector<float> &largestY,
+				QString &sError )
+{
+	return reader.parseCompressed( compressed.constData(), compressed.size(), columns, smallestY, largestY, sError );
+}
+
+// returns text compressed as a single gzip member
+QByteArray gzip( const QByteArray &text )
+{
+	z_stream stream;
+	memset( &stream, 0, sizeof( stream ) );
+	deflateInit2( &stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY );
+	QByteArray compressed( (int) deflateBound( &stream, text.size() ), '\0' );
+	stream.next_in = (Bytef *) text.constData();
+	stream.avail_in = text.size();
+	stream.next_out = (Bytef *) compressed.data();
+	stream.avail_out = compressed.size();
+	deflate( &stream, Z_FINISH );
+	compressed.resize( (int) stream.total_out );
+	deflateEnd( &stream );
+	return compressed;
+}
+
+// returns true if both files parsed to the same bits, NaN included
+bool sameParse( const QVector< QVector<float> > &columns,
+				const QVector<float> &smallestY,
+				const QVector<float> &largestY,
+				const QVector< QVector<float> > &expectedColumns,
+				const QVector<float> &expectedSmallestY,
+				const QVector<float> &expectedLargestY )
+{
+	bool bSame = columns.count() == expectedColumns.count() &&
+				 smallestY == expectedSmallestY &&
+				 largestY == expectedLargestY;
+	for ( int ii=0; bSame && ii<columns.count(); ii++ )
+	{
+		bSame = columns.at( ii ).size() == expectedColumns.at( ii ).size() &&
+				!memcmp( columns.at( ii ).constData(), expectedColumns.at( ii ).constData(),
+						 columns.at( ii ).size() * sizeof( float ) );
+	}
+	return bSame;
+}
+
+// returns lines numbered from 0, each holding its number and its number + 0.5, w/ blank lines
+// 2 and 3 so that the line numbers differ from the data points
+QByteArray numberedLines( int numLines )
+{
+	QByteArray text;
+	char line[ 64 ];
+	for ( int ii=0; ii<numLines; ii++ )
+	{
+		int length = ii == 2 || ii == 3 ? snprintf( line, sizeof( line ), "\n" )
+										: snprintf( line, sizeof( line ), "%07d,%07d.5\n", ii, ii );
+		text.append( line, length );
+	}
+	return text;
+}
+
+// every delimiter is detected from the 1st data line and splits it into the same columns
+// the smallest and largest values start at 1 and -1, since they set the scale of the signals
+void testDelimiters()
+{
+	const char *texts[] =
+	{
+		"1,2,3\n4,5,6\n",
+		"1;2;3\n4;5;6\n",
+		"1\t2\t3\n4\t5\t6\n",
+		"1 2  3\n  4 5\t6\n"
+	};
+
+	for ( const char *text : texts )
+	{
+		SignalFileReader reader;
+		QVector< QVector<float> > columns;
+		QVector<float> smallestY,
+				largestY;
+		QString sError;
+		CHECK( parseText( reader, text, columns, smallestY, largestY, sError ) );
+		CHECK( columns.count() == 3 );
+		for ( int ii=0; ii<columns.count(); ii++ )
+		{
+			CHECK( columns.at( ii ).size() == 2 );
+			CHECK( columns.at( ii ).at( 0 ) == ii + 1 );
+			CHECK( columns.at( ii ).at( 1 ) == ii + 4 );
+			CHECK( smallestY.at( ii ) == 1.0f );
+			CHECK( largestY.at( ii ) == ii + 4 );
+		}
+	}
+
+	// a delimiter that is set is used even if the line has others
+	SignalFileReader reader;
+	reader.setDelimiter( ';' );
+	QVector< QVector<float> > columns;
+	QVector<float> smallestY,
+			largestY;
+	QString sError;
+	CHECK( !parseText( reader, "1,5;2\n3,5;4\n", columns, smallestY, largestY, sError ) );
+	CHECK( parseText( reader, "1.5;2\n3.5;4\n", columns, smallestY, largestY, sError ) );
+	CHECK( columns.count() == 2 && columns.at( 0 ).at( 1 ) == 3.5f );
+}
+
+// the header row, the byte order mark, carriage returns and blank lines are all skipped
+void testSkippedText()
+{
+	SignalFileReader reader;
+	QVector< QVector<float> > columns;
+	QVector<float> smallestY,
+			largestY;
+	QString sError;
+
+	CHECK( !parseText( reader, "time,value\n1,2\n", columns, smallestY, largestY, sError ) );
+	reader.setHeaderRow( true );
+	CHECK( parseText( reader, "\ntime,value\n1,2\n3,4\n", columns, smallestY, largestY, sError ) );
+	CHECK( columns.count() == 2 && columns.at( 1 ).size() == 2 && columns.at( 1 ).at( 1 ) == 4.0f );
+
+	CHECK( parseText( reader, "\xEF\xBB\xBFtime,value\n1,2\n", columns, smallestY, largestY, sError ) );
+	CHECK( columns.count() == 2 && columns.at( 0 ).at( 0 ) == 1.0f );
+	reader.setHeaderRow( false );
+	CHECK( parseText( reader, "\xEF\xBB\xBF" "1,2\n3,4\n", columns, smallestY, largestY, sError ) );
+	CHECK( columns.count() == 2 && columns.at( 0 ).at( 0 ) == 1.0f );
+
+	CHECK( parseText( reader, "1,2\r\n3,4\r\n", columns, smallestY, largestY, sError ) );
+	CHECK( columns.count() == 2 && columns.at( 1 ).size() == 2 && columns.at( 1 ).at( 1 ) == 4.0f );
+
+	CHECK( parseText( reader, "\n\n1,2\n\n \t\r\n3,4\n\n", columns, smallestY, largestY, sError ) );
+	CHECK( columns.count() == 2 && columns.at( 0 ).size() == 2 && columns.at( 0 ).at( 1 ) == 3.0f );
+
+	// the last line need not end w/ a new line
+	CHECK( parseText( reader, "1,2\n3,4", columns, smallestY, largestY, sError ) );
+	CHECK( columns.count() == 2 && columns.at( 1 ).size() == 2 && columns.at( 1 ).at( 1 ) == 4.0f );
+
+	CHECK( !parseText( reader, "\n \n", columns, smallestY, largestY, sError ) );
+	CHECK( sError == "Contains no data" );
+}
+
+// empty fields are missing data points, which are left out of the smallest and largest values
+void testEmptyFields()
+{
+	SignalFileReader reader;
+	QVector< QVector<float> > columns;
+	QVector<float> smallestY,
+			largestY;
+	QString sError;
+	CHECK( parseText( reader, "1,,3\n, 5 ,\n7,8,nan\n,-2,\n", columns, smallestY, largestY, sError ) );
+	CHECK( columns.count() == 3 );
+	CHECK( columns.at( 0 ).at( 0 ) == 1.0f && std::isnan( columns.at( 0 ).at( 1 ) ) && columns.at( 0 ).at( 2 ) == 7.0f );
+	CHECK( std::isnan( columns.at( 1 ).at( 0 ) ) && columns.at( 1 ).at( 1 ) == 5.0f && columns.at( 1 ).at( 2 ) == 8.0f );
+	CHECK( columns.at( 2 ).at( 0 ) == 3.0f && std::isnan( columns.at( 2 ).at( 1 ) ) && std::isnan( columns.at( 2 ).at( 2 ) ) );
+	CHECK( std::isnan( columns.at( 0 ).at( 3 ) ) && columns.at( 1 ).at( 3 ) == -2.0f && std::isnan( columns.at( 2 ).at( 3 ) ) );
+	CHECK( smallestY.at( 0 ) == 1.0f && largestY.at( 0 ) == 7.0f );
+	CHECK( smallestY.at( 1 ) == -2.0f && largestY.at( 1 ) == 8.0f );
+	CHECK( smallestY.at( 2 ) == 1.0f && largestY.at( 2 ) == 3.0f );
+}
+
+// the line of an error is that of the file whichever chunk it is parsed in, the file being big
+// enough to be split into several chunks, and the error being put on the lines around each
+// eighth of it, where the chunks start
+void testErrorLines()
+{
+	const int numLines = 480000;
+	QByteArray text = numberedLines( numLines );
+	const int lineSize = 18;
+
+	QVector<int> errorLines;
+	errorLines.push_back( 0 );
+	errorLines.push_back( 1 );
+	for ( int ii=1; ii<8; ii++ )
+	{
+		for ( int delta=-1; delta<=2; delta++ )
+			errorLines.push_back( numLines * ii / 8 + delta );
+	}
+	errorLines.push_back( numLines - 1 );
+
+	for ( int line : errorLines )
+	{
+		// lines 2 and 3 are blank, so every line after them starts 2 * 17 bytes earlier
+		int offset = line < 2 ? line * lineSize : line * lineSize - 2 * ( lineSize - 1 );
+		// the 1st data line sets the number of columns, so it can't have the wrong number
+		for ( int bBadCount=0; bBadCount<( line ? 2 : 1 ); bBadCount++ )
+		{
+			QByteArray badText = text;
+			if ( bBadCount )
+				badText[ offset + 15 ] = ',';
+			else
+				badText[ offset + 9 ] = 'z';
+
+			SignalFileReader reader;
+			QVector< QVector<float> > columns;
+			QVector<float> smallestY,
+					largestY;
+			QString sError;
+			CHECK( !parseText( reader, badText, columns, smallestY, largestY, sError ) );
+			QString sExpected = bBadCount ? QString( "Inconsistent number of values per line at line %1" )
+										  : QString( "Contains non-numbers at line %1" );
+			CHECK( sError == sExpected.arg( line + 1 ) );
+			if ( sError != sExpected.arg( line + 1 ) )
+				fprintf( stderr, "  line %d: %s\n", line + 1, sError.toUtf8().constData() );
+		}
+	}
+
+	SignalFileReader reader;
+	QVector< QVector<float> > columns;
+	QVector<float> smallestY,
+			largestY;
+	QString sError;
+	CHECK( parseText( reader, text, columns, smallestY, largestY, sError ) );
+	CHECK( columns.count() == 2 && columns.at( 0 ).size() == numLines - 2 );
+	CHECK( columns.at( 0 ).last() == numLines - 1 && columns.at( 1 ).last() == numLines - 0.5f );
+}
+
+// a file w/o the expected number of data points, or too big for the memory budget, is rejected
+void testRejections()
+{
+	SignalFileReader reader;
+	QVector< QVector<float> > columns;
+	QVector<float> smallestY,
+			largestY;
+	QString sError;
+
+	reader.setExpectedDataPoints( 3 );
+	CHECK( !parseText( reader, "1,2\n3,4\n", columns, smallestY, largestY, sError ) );
+	CHECK( sError == s_mismatchError );
+	CHECK( !parseText( reader, "1,2\n3,4\n5,6\n7,8\n", columns, smallestY, largestY, sError ) );
+	CHECK( sError == s_mismatchError );
+	CHECK( parseText( reader, "1,2\n3,4\n\n5,6\n", columns, smallestY, largestY, sError ) );
+	CHECK( SignalMemory::used() == 0 );
+
+	qint64 budget = SignalMemory::budget();
+	SignalMemory::setBudget( SignalMemory::signalBytes( 3 ) * 2 - 1 );
+	CHECK( !parseText( reader, "1,2\n3,4\n5,6\n", columns, smallestY, largestY, sError ) );
+	CHECK( !sError.isEmpty() );
+	SignalMemory::setBudget( budget );
+	CHECK( SignalMemory::used() == 0 );
+}
+
+// a gzip file parses to the same columns as the text it holds, whether it is a single member or
+// several, split anywhere in a line, and whether it decompresses to one chunk or to many,
+// w/ lines across the chunks
+void testCompressed()
+{
+	QByteArray texts[ 2 ];
+	texts[ 0 ] = "time,value,other\n\n1,-2.5,\n2,,nan\n3,4.25,1e3\n";
+	char line[ 64 ];
+	for ( int ii=0; ii<500000; ii++ )
+	{
+		// lines of many lengths, so that the chunks end in the middle of them
+		int length = ii % 1000 == 999 ? snprintf( line, sizeof( line ), "%d,,\n", ii )
+									  : snprintf( line, sizeof( line ), "%d,%.*f,%d\n", ii, ii % 7, ii * 0.37, -ii % 13 );
+		texts[ 1 ].append( line, length );
+	}
+	CHECK( texts[ 1 ].size() > 2 * ( 4 << 20 ) );
+
+	for ( const QByteArray &text : texts )
+	{
+		SignalFileReader reader;
+		reader.setHeaderRow( text.at( 0 ) == 't' );
+		QVector< QVector<float> > expectedColumns;
+		QVector<float> expectedSmallestY,
+				expectedLargestY;
+		QString sError;
+		CHECK( parseText( reader, text, expectedColumns, expectedSmallestY, expectedLargestY, sError ) );
+		CHECK( expectedColumns.count() == 3 );
+
+		int middle = text.size() / 2 + 3;
+		QByteArray compressedTexts[] =
+		{
+			gzip( text ),
+			gzip( text.left( middle ) ) + gzip( QByteArray() ) + gzip( text.mid( middle ) ),
+			gzip( text.left( 1 ) ) + gzip( text.mid( 1 ) )
+		};
+		for ( const QByteArray &compressed : compressedTexts )
+		{
+			QVector< QVector<float> > columns;
+			QVector<float> smallestY,
+					largestY;
+			CHECK( parseGzip( reader, compressed, columns, smallestY, largestY, sError ) );
+			CHECK( sameParse( columns, smallestY, largestY, expectedColumns, expectedSmallestY, expectedLargestY ) );
+			CHECK( SignalMemory::used() == 0 );
+		}
+
+		// cut short in its last chunk, and in its 1st one
+		QByteArray compressed = gzip( text );
+		int lengths[] = { compressed.size() - 4, compressed.size() / 2, 20 };
+		for ( int length : lengths )
+		{
+			QVector< QVector<float> > columns;
+			QVector<float> smallestY,
+					largestY;
+			CHECK( !parseGzip( reader, compressed.left( length ), columns, smallestY, largestY, sError ) );
+			CHECK( sError == "Compressed data is truncated" );
+			CHECK( SignalMemory::used() == 0 );
+		}
+	}
+
+	// the expected number of data points and the budget are checked as the chunks are counted
+	SignalFileReader reader;
+	QVector< QVector<float> > columns;
+	QVector<float> smallestY,
+			largestY;
+	QString sError;
+	QByteArray compressed = gzip( texts[ 1 ] );
+	reader.setExpectedDataPoints( 1000 );
+	CHECK( !parseGzip( reader, compressed, columns, smallestY, largestY, sError ) );
+	CHECK( sError == s_mismatchError );
+	reader.setExpectedDataPoints( 500001 );
+	CHECK( !parseGzip( reader, compressed, columns, smallestY, largestY, sError ) );
+	CHECK( sError == s_mismatchError );
+	CHECK( SignalMemory::used() == 0 );
+
+	reader.setExpectedDataPoints( 0 );
+	qint64 budget = SignalMemory::budget();
+	SignalMemory::setBudget( SignalMemory::signalBytes( 100000 ) * 3 );
+	CHECK( !parseGzip( reader, compressed, columns, smallestY, largestY, sError ) );
+	CHECK( !sError.isEmpty() );
+	SignalMemory::setBudget( budget );
+	CHECK( SignalMemory::used() == 0 );
+
+	CHECK( !parseGzip( reader, gzip( "\n \n\n" ), columns, smallestY, largestY, sError ) );
+	CHECK( sError == "Contains no data" );
+}
+
+}  // end anonymous namespace
+
+
+// exercises SignalFileReader on text held in memory
+// returns the number of failed checks
+int main( int argc, char *argv[] )
+{
+	QCoreApplication app( argc, argv );
+
+	testDelimiters();
+	testSkippedText();
+	testEmptyFields();
+	testErrorLines();
+	testRejections();
+	testCompressed();
+
+	if ( s_failures )
+		fprintf( stderr, "%d checks failed\n", s_failures );
+	return s_failures;
+}  // end main
@@ -0,0 +1,181 @@
+#include "../signalstatistics.h"
+
+#include <QCoreApplication>
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+
+#include "testcheck.h"
+
+
+namespace
+{
+
+const float s_nan = std::numeric_limits<float>::quiet_NaN();
+
+// the statistics of data over [first, last] summed directly, in long double
+SignalRangeStatistics directRange( const QVector<float> &data, int first, int last )
+{
+	SignalRangeStatistics statistics;
+	long double sum = 0.0L;
+	int count = 0;
+	for ( int ii=first; ii<=last; ii++ )
+	{
+		if ( data.at( ii ) == data.at( ii ) )
+		{
+			sum += data.at( ii );
+			count++;
+		}
+	}
+
+	statistics.count = count;
+	if ( !count )
+	{
+		statistics.mean = statistics.rms = statistics.standardDeviation = statistics.area = 0.0;
+		return statistics;
+	}
+
+	long double mean = sum / count,
+			squares = 0.0L;
+	for ( int ii=first; ii<=last; ii++ )
+	{
+		if ( data.at( ii ) == data.at( ii ) )
+			squares += ( data.at( ii ) - mean ) * ( data.at( ii ) - mean );
+	}
+
+	statistics.mean = (double) mean;
+	statistics.standardDeviation = (double) sqrtl( squares / count );
+	statistics.rms = (double) sqrtl( squares / count + mean * mean );
+
+	// the end points of the trapezoidal rule only count half
+	long double area = sum;
+	if ( data.at( first ) == data.at( first ) )
+		area -= 0.5L * data.at( first );
+	if ( data.at( last ) == data.at( last ) )
+		area -= 0.5L * data.at( last );
+	statistics.area = (double) area;
+	return statistics;
+}
+
+bool isClose( double value, double expected, double tolerance )
+{
+	return fabs( value - expected ) <= tolerance * qMax( 1.0, fabs( expected ) );
+}
+
+// returns the sum of the squares of data about its mean
+double totalSquares( const QVector<float> &data )
+{
+	SignalRangeStatistics all = directRange( data, 0, data.size() - 1 );
+	return all.standardDeviation * all.standardDeviation * all.count;
+}
+
+// checks the statistics of data over [first, last] against those summed directly, the
+// variance being the difference of two prefix sums of squares, it is off by about the
+// precision of the sum of the squares of the whole signal, spread over the range
+// returns false if they differ
+bool checkRange( const SignalStatistics &statistics, const QVector<float> &data, int first, int last,
+				 double squares, double tolerance )
+{
+	SignalRangeStatistics range = statistics.range( data, first, last ),
+			expected = directRange( data, first, last );
+	double variance = range.standardDeviation * range.standardDeviation,
+			expectedVariance = expected.standardDeviation * expected.standardDeviation;
+	bool bOk = range.count == expected.count &&
+			   isClose( range.mean, expected.mean, tolerance ) &&
+			   isClose( range.rms, expected.rms, tolerance ) &&
+			   fabs( variance - expectedVariance ) <= 1e-13 * squares / qMax( range.count, 1 ) +
+													   tolerance * expectedVariance &&
+			   isClose( range.area, expected.area, tolerance );
+	if ( !bOk )
+	{
+		fprintf( stderr, "  [%d, %d]: count %d %d mean %.12g %.12g sd %.12g %.12g area %.12g %.12g\n",
+				 first, last, range.count, expected.count, range.mean, expected.mean,
+				 range.standardDeviation, expected.standardDeviation, range.area, expected.area );
+	}
+	return bOk;
+}
+
+// random ranges of a signal w/ runs of missing data points, and ranges of a single data point
+void testGaps()
+{
+	srand( 1 );
+	QVector<float> data( 200000 );
+	for ( int ii=0; ii<data.size(); ii++ )
+		data[ ii ] = ( rand() % 20001 - 10000 ) / 100.0f;
+	for ( int gap=0; gap<50; gap++ )
+	{
+		int first = rand() % data.size(),
+				length = 1 + rand() % 3000;
+		for ( int ii=first; ii<qMin( first + length, data.size() ); ii++ )
+			data[ ii ] = s_nan;
+	}
+	data[ 0 ] = s_nan;
+	data[ data.size() - 1 ] = s_nan;
+
+	SignalStatistics statistics;
+	statistics.build( data );
+	double squares = totalSquares( data );
+	for ( int ii=0; ii<500; ii++ )
+	{
+		int first = rand() % data.size(),
+				last = first + rand() % ( data.size() - first );
+		CHECK( checkRange( statistics, data, first, last, squares, 1e-9 ) );
+	}
+	CHECK( checkRange( statistics, data, 0, data.size() - 1, squares, 1e-9 ) );
+
+	// a single data point has itself as the mean, no deviation and no area
+	for ( int ii=0; ii<data.size(); ii+=997 )
+	{
+		CHECK( checkRange( statistics, data, ii, ii, squares, 1e-9 ) );
+		SignalRangeStatistics range = statistics.range( data, ii, ii );
+		CHECK( range.count == ( data.at( ii ) == data.at( ii ) ? 1 : 0 ) );
+		CHECK( fabs( range.area ) < 1e-9 );
+	}
+
+	// nothing but missing data points
+	QVector<float> missing( 1000, s_nan );
+	statistics.build( missing );
+	SignalRangeStatistics range = statistics.range( missing, 10, 500 );
+	CHECK( range.count == 0 && range.mean == 0.0 && range.rms == 0.0 && range.area == 0.0 );
+}
+
+// a long signal w/ a large mean and small variations keeps the precision of its deviation far
+// into it, since the sums are taken relative to the mean
+void testLargeMean()
+{
+	QVector<float> data( 4000000 );
+	for ( int ii=0; ii<data.size(); ii++ )
+		data[ ii ] = 10000.0f + (float) sin( ii * 0.001 ) + ( ii % 7 ) * 0.125f;
+
+	SignalStatistics statistics;
+	statistics.build( data );
+	double squares = totalSquares( data );
+	int lengths[] = { 2, 10, 1000, 100000, 3999999 };
+	for ( int length : lengths )
+	{
+		int first = data.size() - length;
+		CHECK( checkRange( statistics, data, first, data.size() - 1, squares, 1e-12 ) );
+		CHECK( checkRange( statistics, data, 0, length - 1, squares, 1e-12 ) );
+		CHECK( checkRange( statistics, data, data.size() / 2 - length / 2, data.size() / 2 + ( length - 1 ) / 2,
+						   squares, 1e-12 ) );
+	}
+}
+
+}  // end anonymous namespace
+
+
+// exercises SignalStatistics against statistics summed directly
+// returns the number of failed checks
+int main( int argc, char *argv[] )
+{
+	QCoreApplication app( argc, argv );
+
+	testGaps();
+	testLargeMean();
+
+	if ( s_failures )
+		fprintf( stderr, "%d checks failed\n", s_failures );
+	return s_failures;
+}  // end main
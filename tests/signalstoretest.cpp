@@ -0,0 +1,211 @@
+#include "../signalstore.h"
+#include "../chartlayout.h"
+
+#include <QCoreApplication>
+#include <QFuture>
+#include <QtConcurrent>
+
+#include <atomic>
+#include <cmath>
+
+#include "testcheck.h"
+
+
+namespace
+{
+
+// returns numColumns columns of dataPoints data points, column ii holding ii + the time
+void makeColumns( int numColumns, int dataPoints,
+				  QVector< QVector<float> > &columns,
+				  QVector< SignalSummary > &summaries )
+{
+	columns.resize( numColumns );
+	summaries.resize( numColumns );
+	for ( int ii=0; ii<numColumns; ii++ )
+	{
+		columns[ ii ].resize( dataPoints );
+		for ( int jj=0; jj<dataPoints; jj++ )
+			columns[ ii ][ jj ] = ii + jj;
+		summaries[ ii ].build( columns.at( ii ), ii, ii + dataPoints - 1 );
+		summaries[ ii ].setScale( 1.0f );
+	}
+}
+
+// a file w/ a different number of data points is rejected and leaves the store as it was
+void testSampleCountMismatch()
+{
+	SignalStore store;
+	QVector< QVector<float> > columns;
+	QVector< SignalSummary > summaries;
+	QString sError;
+	makeColumns( 2, 100, columns, summaries );
+	CHECK( store.addSignals( columns, summaries, sError ) );
+
+	SignalSnapshotPtr before = store.snapshot();
+	makeColumns( 1, 50, columns, summaries );
+	CHECK( !store.addSignals( columns, summaries, sError ) );
+	CHECK( !sError.isEmpty() );
+	CHECK( store.snapshot() == before );
+	CHECK( store.snapshot()->signalCount() == 2 );
+	CHECK( store.snapshot()->numDataPoints == 100 );
+}
+
+// no more signals are added than there are colors to draw them in, even by concurrent writers
+void testSignalLimit()
+{
+	SignalStore store;
+	QVector< QVector<float> > columns;
+	QVector< SignalSummary > summaries;
+	QString sError;
+	makeColumns( ChartLayout::s_maxSignals - 2, 100, columns, summaries );
+	CHECK( store.addSignals( columns, summaries, sError ) );
+
+	SignalSnapshotPtr before = store.snapshot();
+	makeColumns( 3, 100, columns, summaries );
+	CHECK( !store.addSignals( columns, summaries, sError ) );
+	CHECK( !sError.isEmpty() );
+	CHECK( store.snapshot() == before );
+
+	store.clear();
+	std::atomic< int > added( 0 );
+	QVector< QFuture<void> > writers;
+	for ( int ii=0; ii<4; ii++ )
+	{
+		writers.push_back( QtConcurrent::run( [&]()
+		{
+			for ( int jj=0; jj<ChartLayout::s_maxSignals; jj++ )
+			{
+				QVector< QVector<float> > writerColumns;
+				QVector< SignalSummary > writerSummaries;
+				QString sWriterError;
+				makeColumns( 1, 100, writerColumns, writerSummaries );
+				if ( store.addSignals( writerColumns, writerSummaries, sWriterError ) )
+					added++;
+			}
+		} ) );
+	}
+	for ( QFuture<void> &writer : writers )
+		writer.waitForFinished();
+	CHECK( added == ChartLayout::s_maxSignals );
+	CHECK( store.snapshot()->signalCount() == ChartLayout::s_maxSignals );
+}
+
+// a snapshot taken before a write still shows the signals as they were
+void testSnapshotImmutability()
+{
+	SignalStore store;
+	QVector< QVector<float> > columns;
+	QVector< SignalSummary > summaries;
+	QString sError;
+	makeColumns( 2, 100, columns, summaries );
+	CHECK( store.addSignals( columns, summaries, sError ) );
+
+	SignalSnapshotPtr first = store.snapshot();
+	makeColumns( 1, 100, columns, summaries );
+	CHECK( store.addSignals( columns, summaries, sError ) );
+	store.setTimeOffset( 1, 5 );
+
+	SignalSnapshotPtr last = store.snapshot();
+	CHECK( first->signalCount() == 2 );
+	CHECK( first->timeOffsets.at( 1 ) == 0 );
+	CHECK( first->value( 1, 10 ) == 11.0f );
+	CHECK( last->version > first->version );
+	CHECK( last->signalCount() == 3 );
+	CHECK( last->timeOffsets.at( 1 ) == 5 );
+	CHECK( last->value( 1, 10 ) == 6.0f );
+	CHECK( std::isnan( last->value( 1, 2 ) ) );
+
+	// the data is shared between the versions, not copied
+	CHECK( first->vectorSignals.at( 0 ).constData() == last->vectorSignals.at( 0 ).constData() );
+}
+
+// readers on other threads always see a consistent version while the store is written
+void testConcurrentReaders()
+{
+	SignalStore store;
+	std::atomic< bool > bWriting( true );
+	std::atomic< int > inconsistent( 0 );
+
+	QVector< QFuture<void> > readers;
+	for ( int ii=0; ii<4; ii++ )
+	{
+		readers.push_back( QtConcurrent::run( [&]()
+		{
+			quint64 version = 0;
+			while ( bWriting )
+			{
+				SignalSnapshotPtr snapshot = store.snapshot();
+				bool bConsistent = snapshot->version >= version &&
+						snapshot->vectorSummaries.count() == snapshot->signalCount() &&
+						snapshot->vectorStatistics.count() == snapshot->signalCount() &&
+						snapshot->vectorEvents.count() == snapshot->signalCount() &&
+						snapshot->timeOffsets.count() == snapshot->signalCount();
+				for ( int jj=0; bConsistent && jj<snapshot->signalCount(); jj++ )
+					bConsistent = snapshot->vectorSignals.at( jj ).size() == snapshot->numDataPoints;
+				if ( !bConsistent )
+					inconsistent++;
+				version = snapshot->version;
+			}
+		} ) );
+	}
+
+	QVector< QVector<float> > columns;
+	QVector< SignalSummary > summaries;
+	QString sError;
+	for ( int ii=0; ii<200; ii++ )
+	{
+		if ( store.snapshot()->signalCount() >= 7 )
+			store.clear();
+		makeColumns( 1, 1000, columns, summaries );
+		CHECK( store.addSignals( columns, summaries, sError ) );
+		store.setTimeOffset( 0, ii );
+		store.setEventThreshold( ii % 10 );
+	}
+
+	bWriting = false;
+	for ( QFuture<void> &reader : readers )
+		reader.waitForFinished();
+	CHECK( inconsistent == 0 );
+}
+
+// a slot connected directly to the store may write to it w/o deadlocking
+void testWriteFromSlot()
+{
+	SignalStore store;
+	QVector< QVector<float> > columns;
+	QVector< SignalSummary > summaries;
+	QString sError;
+	makeColumns( 2, 100, columns, summaries );
+	CHECK( store.addSignals( columns, summaries, sError ) );
+
+	int calls = 0;
+	QObject::connect( &store, &SignalStore::qtsignalSnapshotChanged, [&]()
+	{
+		if ( calls++ == 0 )
+			store.setTimeOffset( 1, 3 );
+	} );
+	store.setTimeOffset( 0, 2 );
+	CHECK( calls == 2 );
+	CHECK( store.snapshot()->timeOffsets.at( 0 ) == 2 );
+	CHECK( store.snapshot()->timeOffsets.at( 1 ) == 3 );
+}
+
+}  // end anonymous namespace
+
+
+// exercises SignalStore w/o a display or OpenGL
+// returns the number of failed checks
+int main( int argc, char *argv[] )
+{
+	QCoreApplication app( argc, argv );
+
+	testSampleCountMismatch();
+	testSignalLimit();
+	testSnapshotImmutability();
+	testConcurrentReaders();
+	testWriteFromSlot();
+
+	if ( s_failures )
+		fprintf( stderr, "%d checks failed\n", s_failures );
+	return s_failures;
+}  // end main
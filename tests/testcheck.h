@@ -0,0 +1,21 @@
+#ifndef TESTCHECK_H
+#define TESTCHECK_H
+
+#include <cstdio>
+
+
+// the headless tests count the checks that fail and return the count from main(), which is all
+// ctest needs, so they do w/o a test framework
+static int s_failures = 0;
+
+#define CHECK( condition ) \
+	do \
+	{ \
+		if ( !( condition ) ) \
+		{ \
+			fprintf( stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition ); \
+			s_failures++; \
+		} \
+	} while ( false )
+
+#endif // TESTCHECK_H
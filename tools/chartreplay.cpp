@@ -0,0 +1,59 @@
+#include "../chartwidget.h"
+#include "../interactiontrace.h"
+
+#include <QApplication>
+#include <QStringList>
+#include <QTextStream>
+
+
+// replays a trace recorded w/ InteractionRecorder against a chart and reports how long every
+// type of event took to handle and to render
+// usage: chartreplay <trace> [--budget-ms <milliseconds>]
+// runs on the offscreen platform unless QT_QPA_PLATFORM says otherwise, and exits w/ 1 if the
+// trace could not be replayed or w/ 2 if the 95th percentile latency is over the budget
+int main( int argc, char *argv[] )
+{
+	if ( qEnvironmentVariableIsEmpty( "QT_QPA_PLATFORM" ) )
+		qputenv( "QT_QPA_PLATFORM", "offscreen" );
+
+	QApplication app( argc, argv );
+	QTextStream out( stdout ),
+			err( stderr );
+
+	QStringList arguments = app.arguments();
+	QString traceFile;
+	double budget = 0.0;
+	for ( int ii=1; ii<arguments.count(); ii++ )
+	{
+		if ( arguments.at( ii ) == "--budget-ms" && ii + 1 < arguments.count() )
+			budget = arguments.at( ++ii ).toDouble();
+		else
+			traceFile = arguments.at( ii );
+	}
+	if ( traceFile.isEmpty() )
+	{
+		err << "usage: chartreplay <trace> [--budget-ms <milliseconds>]\n";
+		return 1;
+	}
+
+	QString sError;
+	InteractionReplayer replayer;
+	ChartWidget chart;
+	if ( !replayer.load( traceFile, sError ) ||
+		 !replayer.replay( &chart, sError ) )
+	{
+		err << sError << "\n";
+		return 1;
+	}
+
+	replayer.report( out );
+	double latency = replayer.latencyPercentile( 0.95 ) / 1e6;
+	out << "p95 latency ms " << QString::number( latency, 'f', 3 ) << "\n";
+	if ( budget > 0.0 && latency > budget )
+	{
+		out << "over the budget of " << budget << " ms\n";
+		return 2;
+	}
+
+	return 0;
+}  // end main